@@ -0,0 +1,139 @@
+// Microbenchmark: ProcNetParser vs. the original istringstream line parser.
+//
+// Usage: proc_net_parser_bench [rows] [iterations]
+//
+// Generates a synthetic /proc/net/tcp with `rows` sockets (10% LISTEN) and
+// times both parsers collecting LISTEN rows from it, then does the same for
+// the live /proc/net/tcp.
+
+#include "platform/proc_net_parser.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace zohd::platform;
+
+namespace {
+
+struct Listener {
+    uint16_t port;
+    uint32_t uid;
+    unsigned long inode;
+};
+
+// The parser that lived in linux_impl.cpp before ProcNetParser
+void legacy_parse(const char* path, std::vector<Listener>& out) {
+    std::ifstream file(path);
+    if (!file.is_open()) return;
+
+    std::string line;
+    std::getline(file, line);  // Skip header
+
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string sl;
+        std::string local_address, rem_address, st;
+        unsigned long inode = 0;
+        uint32_t uid = 0;
+
+        iss >> sl >> local_address >> rem_address >> st;
+        if (st != "0A") continue;
+
+        std::string skip;
+        for (int i = 0; i < 3; i++) iss >> skip;
+        iss >> uid >> skip >> inode;
+
+        size_t colon_pos = local_address.find(':');
+        if (colon_pos != std::string::npos && colon_pos + 1 < local_address.size()) {
+            std::string port_hex = local_address.substr(colon_pos + 1);
+            try {
+                uint16_t port = static_cast<uint16_t>(std::stoul(port_hex, nullptr, 16));
+                out.push_back({port, uid, inode});
+            } catch (const std::exception&) {
+                continue;
+            }
+        }
+    }
+}
+
+void fast_parse(ProcNetParser& parser, const char* path, std::vector<Listener>& out) {
+    if (!parser.load(path)) return;
+    parser.for_each(state_bit(TCP_STATE_LISTEN), [&](const ProcNetRow& row) {
+        out.push_back({row.local_port, row.uid, row.inode});
+    });
+}
+
+std::string write_fixture(size_t rows) {
+    char path[] = "/tmp/zohd_proc_net_tcp_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        std::perror("mkstemp");
+        std::exit(1);
+    }
+    close(fd);
+
+    std::ofstream file(path);
+    file << "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when retrnsmt"
+            "   uid  timeout inode\n";
+
+    char line[256];
+    for (size_t i = 0; i < rows; i++) {
+        bool listen = i % 10 == 0;
+        unsigned port = listen ? 1024 + static_cast<unsigned>(i % 60000) : 40000 + static_cast<unsigned>(i % 20000);
+        std::snprintf(line, sizeof(line),
+                      "%4zu: 0100007F:%04X %08X:%04X %02X 00000000:00000000 00:00000000 00000000 %5u"
+                      "        0 %zu 1 0000000000000000 100 0 0 10 0\n",
+                      i, port, listen ? 0U : 0x0100007FU, listen ? 0U : 5432U,
+                      listen ? 0x0AU : 0x01U, 1000U, 100000 + i);
+        file << line;
+    }
+    return path;
+}
+
+template <typename Fn>
+double time_ms(int iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) fn();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count() / iterations;
+}
+
+void run(const char* label, const char* path, int iterations) {
+    ProcNetParser parser;
+    std::vector<Listener> legacy, fast;
+    legacy.reserve(65536);
+    fast.reserve(65536);
+
+    double legacy_ms = time_ms(iterations, [&]() { legacy.clear(); legacy_parse(path, legacy); });
+    double fast_ms = time_ms(iterations, [&]() { fast.clear(); fast_parse(parser, path, fast); });
+
+    bool same = legacy.size() == fast.size();
+    for (size_t i = 0; same && i < legacy.size(); i++) {
+        same = legacy[i].port == fast[i].port && legacy[i].uid == fast[i].uid &&
+               legacy[i].inode == fast[i].inode;
+    }
+
+    std::printf("%-24s listeners=%-7zu legacy=%9.3f ms  parser=%9.3f ms  speedup=%6.1fx  %s\n",
+                label, fast.size(), legacy_ms, fast_ms, fast_ms > 0 ? legacy_ms / fast_ms : 0.0,
+                same ? "match" : "MISMATCH");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 60000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    std::string fixture = write_fixture(rows);
+    std::string label = "synthetic (" + std::to_string(rows) + " rows)";
+    run(label.c_str(), fixture.c_str(), iterations);
+    unlink(fixture.c_str());
+
+    run("/proc/net/tcp", "/proc/net/tcp", iterations);
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "procfs_fixture.hpp"
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace zohd {
+namespace bench {
+
+namespace {
+
+[[noreturn]] void fail(const std::string& what, const std::string& path) {
+    throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+void make_dir(const std::string& path) {
+    if (mkdir(path.c_str(), 0755) != 0) fail("mkdir", path);
+}
+
+void write_file(const std::string& path, const std::string& content) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) fail("open", path);
+
+    size_t written = 0;
+    while (written < content.size()) {
+        ssize_t n = write(fd, content.data() + written, content.size() - written);
+        if (n < 0) {
+            close(fd);
+            fail("write", path);
+        }
+        written += static_cast<size_t>(n);
+    }
+    close(fd);
+}
+
+void make_link(const std::string& target, const std::string& path) {
+    if (symlink(target.c_str(), path.c_str()) != 0) fail("symlink", path);
+}
+
+const char* const TCP_HEADER =
+    "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when retrnsmt"
+    "   uid  timeout inode\n";
+
+// /proc/<pid>/stat with starttime (field 22) set
+std::string stat_line(uint32_t pid, size_t index) {
+    std::string line = std::to_string(pid) + " (svc-" + std::to_string(index) + ") S 1 " +
+                       std::to_string(pid) + " " + std::to_string(pid) + " 0 -1 4194560";
+    // Fields 10-21 are counters and scheduling values
+    for (int field = 10; field <= 21; field++) line += " 0";
+    line += " " + std::to_string(100000 + index);
+    for (int field = 23; field <= 52; field++) line += " 0";
+    return line + "\n";
+}
+
+} // namespace
+
+Fixture build_procfs_fixture(const FixtureSpec& spec, const std::string& parent) {
+    if (spec.processes == 0) throw std::runtime_error("fixture needs at least one process");
+
+    Fixture fixture;
+    std::string templ = parent + "/zohd_procfs_XXXXXX";
+    if (!mkdtemp(templ.data())) fail("mkdtemp", templ);
+    fixture.root = templ;
+
+    write_file(fixture.root + "/uptime", "86400.00 172800.00\n");
+
+    // Socket tables: TCP rows, the other tables header-only
+    make_dir(fixture.root + "/net");
+    std::string tcp = TCP_HEADER;
+    tcp.reserve(tcp.size() + spec.sockets * 160);
+    char row[256];
+    size_t listeners = 0;
+    for (size_t k = 0; k < spec.sockets; k++) {
+        // Spread LISTEN rows evenly; ports 10000-65534 are available for them
+        bool listen = std::floor((k + 1) * spec.listen_ratio) > std::floor(k * spec.listen_ratio) &&
+                      listeners < 55535;
+        unsigned long inode = 100000 + k;
+        unsigned port = listen ? 10000 + static_cast<unsigned>(listeners)
+                               : 40000 + static_cast<unsigned>(k % 20000);
+        if (listen) {
+            fixture.listen_ports.push_back(static_cast<uint16_t>(port));
+            fixture.listen_inodes.push_back(inode);
+            listeners++;
+        }
+
+        std::snprintf(row, sizeof(row),
+                      "%4zu: 0100007F:%04X %08X:%04X %02X 00000000:00000000 00:00000000 00000000 %5u"
+                      "        0 %lu 1 0000000000000000 100 0 0 10 0\n",
+                      k, port, listen ? 0U : 0x0100007FU, listen ? 0U : 5432U,
+                      listen ? 0x0AU : 0x01U, 1000U, inode);
+        tcp += row;
+    }
+    write_file(fixture.root + "/net/tcp", tcp);
+    for (const char* table : {"tcp6", "udp", "udp6", "udplite", "udplite6"}) {
+        write_file(fixture.root + "/net/" + table, TCP_HEADER);
+    }
+    write_file(fixture.root + "/net/unix", "Num       RefCount Protocol Flags    Type St Inode Path\n");
+
+    // Processes: socket k belongs to process k % processes
+    fixture.pids.reserve(spec.processes);
+    for (size_t i = 0; i < spec.processes; i++) {
+        uint32_t pid = spec.first_pid + static_cast<uint32_t>(i);
+        std::string dir = fixture.root + "/" + std::to_string(pid);
+        fixture.pids.push_back(pid);
+
+        make_dir(dir);
+        write_file(dir + "/cmdline", "/usr/bin/svc-" + std::to_string(i) + std::string("\0--worker\0", 10));
+        write_file(dir + "/stat", stat_line(pid, i));
+        write_file(dir + "/status", "Name:\tsvc-" + std::to_string(i) +
+                                    "\nUid:\t1000\t1000\t1000\t1000\n");
+
+        make_dir(dir + "/fd");
+        for (size_t fd = 0; fd < spec.fds_per_process; fd++) {
+            std::string target = fd % 2 == 0 ? "/dev/null" : "pipe:[" + std::to_string(50000 + fd) + "]";
+            make_link(target, dir + "/fd/" + std::to_string(fd));
+        }
+        for (size_t k = i, slot = 0; k < spec.sockets; k += spec.processes, slot++) {
+            make_link("socket:[" + std::to_string(100000 + k) + "]",
+                      dir + "/fd/" + std::to_string(spec.fds_per_process + slot));
+            fixture.last_inode = 100000 + k;
+        }
+    }
+
+    return fixture;
+}
+
+void remove_procfs_fixture(const Fixture& fixture) {
+    if (fixture.root.empty()) return;
+    nftw(fixture.root.c_str(),
+         [](const char* path, const struct stat*, int, struct FTW*) { return remove(path); },
+         64, FTW_DEPTH | FTW_PHYS);
+}
+
+} // namespace bench
+} // namespace zohd
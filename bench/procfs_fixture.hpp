@@ -0,0 +1,40 @@
+#pragma once
+
+// Synthetic procfs tree for benchmarks: /proc/net tables, per-process
+// cmdline/stat/status files and fd directories of symlinks, laid out the
+// way the Linux backend reads them (point PlatformOptions::proc_root at it).
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace zohd {
+namespace bench {
+
+struct FixtureSpec {
+    size_t processes = 1000;
+    size_t fds_per_process = 8;   // Non-socket fds in every process
+    size_t sockets = 1000;        // TCP rows in net/tcp, each held by one process
+    double listen_ratio = 0.1;    // Share of the rows in LISTEN state
+    uint32_t first_pid = 1000;
+};
+
+// What was written, for checking results against
+struct Fixture {
+    std::string root;
+    std::vector<uint32_t> pids;
+    std::vector<uint16_t> listen_ports;
+    std::vector<unsigned long> listen_inodes;
+    unsigned long last_inode = 0;   // A socket of the highest PID holding any
+};
+
+// Create the tree under a new directory in `parent`. Throws std::runtime_error
+// on I/O failure.
+Fixture build_procfs_fixture(const FixtureSpec& spec, const std::string& parent = "/tmp");
+
+// Remove a fixture tree
+void remove_procfs_fixture(const Fixture& fixture);
+
+} // namespace bench
+} // namespace zohd
@@ -0,0 +1,194 @@
+// Benchmark suite for the Linux backend against synthetic procfs trees.
+//
+// Usage: zohd_bench [--scales 1000,10000,100000] [--fds N] [--listen-ratio R]
+//                   [-j N] [--time S] [--dir PARENT] [--keep]
+//
+// For each scale N, builds a fake /proc with N processes and N TCP sockets
+// (procfs_fixture.hpp), points the backend at it with proc_root and times
+// the public platform calls. Results go to stdout as one JSON object per
+// line; progress goes to stderr.
+
+#include "CLI11.hpp"
+#include "procfs_fixture.hpp"
+#include "platform/platform_interface.hpp"
+#include "platform/socket_snapshot.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace zohd;
+
+namespace {
+
+// Keeps loop results alive past the optimizer
+volatile size_t g_sink;
+
+struct Stats {
+    size_t iterations = 0;
+    double min_ns = 0;
+    double median_ns = 0;
+    double mean_ns = 0;
+};
+
+// Run `fn` until `budget` seconds have passed (at least 3, at most 10000
+// times). Every run performs `ops` operations; times are per operation.
+template <typename Fn>
+Stats measure(double budget, size_t ops, Fn&& fn) {
+    using clock = std::chrono::steady_clock;
+    std::vector<double> samples;
+
+    auto deadline = clock::now() + std::chrono::duration<double>(budget);
+    while (samples.size() < 3 || (clock::now() < deadline && samples.size() < 10000)) {
+        auto start = clock::now();
+        fn();
+        auto elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        samples.push_back(elapsed / static_cast<double>(ops));
+    }
+
+    Stats stats;
+    stats.iterations = samples.size();
+    std::sort(samples.begin(), samples.end());
+    stats.min_ns = samples.front();
+    stats.median_ns = samples[samples.size() / 2];
+    for (double sample : samples) stats.mean_ns += sample;
+    stats.mean_ns /= static_cast<double>(samples.size());
+    return stats;
+}
+
+struct Run {
+    size_t scale;
+    const bench::FixtureSpec& spec;
+    const bench::Fixture& fixture;
+    unsigned jobs;
+};
+
+void report(const Run& run, const char* name, size_t ops, const Stats& stats) {
+    std::printf("{\"bench\":\"%s\",\"scale\":%zu,\"processes\":%zu,\"sockets\":%zu,"
+                "\"listeners\":%zu,\"fds_per_process\":%zu,\"jobs\":%u,\"ops\":%zu,"
+                "\"iterations\":%zu,\"min_ns\":%.0f,\"median_ns\":%.0f,\"mean_ns\":%.0f}\n",
+                name, run.scale, run.spec.processes, run.spec.sockets,
+                run.fixture.listen_ports.size(), run.spec.fds_per_process, run.jobs, ops,
+                stats.iterations, stats.min_ns, stats.median_ns, stats.mean_ns);
+    std::fflush(stdout);
+}
+
+void run_scale(const Run& run, double budget) {
+    const auto& fixture = run.fixture;
+    size_t listeners = fixture.listen_ports.size();
+
+    // Sanity check: every listener is found with an owner
+    platform::refresh_current_snapshot();
+    auto connections = platform::get_tcp_connections();
+    size_t owned = std::count_if(connections.begin(), connections.end(),
+                                 [](const PortInfo& info) { return info.process.has_value(); });
+    if (connections.size() != listeners || owned != listeners) {
+        std::fprintf(stderr, "warning: expected %zu owned listeners, got %zu (%zu owned)\n",
+                     listeners, connections.size(), owned);
+    }
+
+    report(run, "get_tcp_connections", 1, measure(budget, 1, []() {
+        platform::refresh_current_snapshot();
+        platform::get_tcp_connections();
+    }));
+
+    // Same, with the owners' files read in batches through io_uring
+    auto options = platform::get_options();
+    options.io_uring = true;
+    platform::set_options(options);
+    report(run, "get_tcp_connections_uring", 1, measure(budget, 1, []() {
+        platform::refresh_current_snapshot();
+        platform::get_tcp_connections();
+    }));
+    options.io_uring = false;
+    platform::set_options(options);
+
+    uint16_t probe = listeners > 0 ? fixture.listen_ports.back() : 10000;
+    report(run, "is_port_in_use_cold", 1, measure(budget, 1, [probe]() {
+        platform::refresh_current_snapshot();
+        platform::is_port_in_use(probe);
+    }));
+
+    // Snapshot in place: every call is a bit test
+    platform::refresh_current_snapshot();
+    platform::is_port_in_use(probe);
+    report(run, "is_port_in_use", 65535, measure(budget, 65535, []() {
+        size_t busy = 0;
+        for (uint32_t port = 1; port <= 65535; port++) {
+            busy += platform::is_port_in_use(static_cast<uint16_t>(port));
+        }
+        g_sink = busy;
+    }));
+
+    // Single-socket lookup (what find_pid_by_inode used to do), owner last
+    std::vector<unsigned long> one{fixture.last_inode};
+    report(run, "find_socket_owners_one", 1, measure(budget, 1, [&one]() {
+        platform::find_socket_owners(one);
+    }));
+
+    report(run, "find_socket_owners_all", 1, measure(budget, 1, [&fixture]() {
+        platform::find_socket_owners(fixture.listen_inodes);
+    }));
+
+    size_t sample = std::min<size_t>(fixture.pids.size(), 1000);
+    report(run, "get_process_info", sample, measure(budget, sample, [&fixture, sample]() {
+        for (size_t i = 0; i < sample; i++) {
+            platform::get_process_info(fixture.pids[i], platform::PROCESS_ALL);
+        }
+    }));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CLI::App app{"zohd_bench - platform backend benchmarks on synthetic procfs trees"};
+
+    std::vector<size_t> scales{1000, 10000, 100000};
+    bench::FixtureSpec spec;
+    unsigned jobs = 1;
+    double budget = 0.5;
+    std::string parent = "/tmp";
+    bool keep = false;
+
+    app.add_option("--scales", scales, "Process and socket counts to run at")->delimiter(',');
+    app.add_option("--fds", spec.fds_per_process, "Non-socket fds per process");
+    app.add_option("--listen-ratio", spec.listen_ratio, "Share of TCP rows in LISTEN")
+       ->check(CLI::Range(0.0, 1.0));
+    app.add_option("-j,--jobs", jobs, "Threads for the fd walk (0 = one per core)");
+    app.add_option("--time", budget, "Seconds to spend on each benchmark")
+       ->check(CLI::PositiveNumber);
+    app.add_option("--dir", parent, "Where to create fixture trees")
+       ->check(CLI::ExistingDirectory);
+    app.add_flag("--keep", keep, "Leave fixture trees in place");
+    CLI11_PARSE(app, argc, argv);
+
+    for (size_t scale : scales) {
+        spec.processes = scale;
+        spec.sockets = scale;
+
+        auto start = std::chrono::steady_clock::now();
+        bench::Fixture fixture;
+        try {
+            fixture = bench::build_procfs_fixture(spec, parent);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "fixture: %s\n", e.what());
+            return 1;
+        }
+        std::fprintf(stderr, "scale %zu: fixture %s built in %.1f s\n", scale, fixture.root.c_str(),
+                     std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        platform::PlatformOptions options;
+        options.proc_root = fixture.root;
+        options.backend = platform::SocketBackend::PROCFS;
+        options.jobs = jobs;
+        options.numeric_users = true;
+        platform::set_options(options);
+
+        run_scale(Run{scale, spec, fixture, jobs}, budget);
+
+        if (!keep) bench::remove_procfs_fixture(fixture);
+    }
+
+    return 0;
+}
@@ -10,15 +10,29 @@ mkdir -p build
 cd build
 
 # Compile all source files
-g++ -std=c++17 -Wall -Wextra -O2 -DPLATFORM_LINUX \
+g++ -std=c++17 -Wall -Wextra -O2 -pthread -DPLATFORM_LINUX \
     -I../include/third_party \
     -I../src \
     ../src/main.cpp \
     ../src/core/port_info.cpp \
     ../src/core/port_scanner.cpp \
     ../src/core/process_manager.cpp \
+    ../src/core/port_watcher.cpp \
+    ../src/core/connection_stats.cpp \
+    ../src/core/ephemeral_ports.cpp \
+    ../src/core/accept_queue.cpp \
+    ../src/core/profiler.cpp \
+    ../src/core/port_lease.cpp \
     ../src/cli/output_formatter.cpp \
+    ../src/cli/output_writer.cpp \
+    ../src/platform/socket_snapshot.cpp \
+    ../src/platform/socket_table.cpp \
     ../src/platform/linux_impl.cpp \
+    ../src/platform/linux_sock_diag.cpp \
+    ../src/platform/linux_inode_index.cpp \
+    ../src/platform/linux_pid_cache.cpp \
+    ../src/platform/linux_uring.cpp \
+    ../src/platform/proc_net_parser.cpp \
     -o zohd
 
 echo "Build successful! Binary: build/zohd"
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+namespace zohd {
+
+// Layout of `--format bin`: one BinaryHeader followed by record_count
+// BinaryRecords. Fields are in the writer's native byte order; byte_order
+// reads back as BINARY_BYTE_ORDER when it matches the reader's. Strings
+// are truncated to fit and NUL-padded.
+
+constexpr char BINARY_MAGIC[4] = {'Z', 'O', 'H', 'D'};
+constexpr uint16_t BINARY_VERSION = 1;
+constexpr uint32_t BINARY_BYTE_ORDER = 0x01020304;
+
+struct BinaryHeader {
+    char magic[4];          // "ZOHD"
+    uint16_t version;       // BINARY_VERSION
+    uint16_t record_size;   // sizeof(BinaryRecord)
+    uint32_t record_count;
+    uint32_t byte_order;    // BINARY_BYTE_ORDER
+};
+
+enum BinaryRecordFlag : uint8_t {
+    RECORD_IN_USE = 1U << 0,
+    RECORD_IPV6 = 1U << 1,
+    RECORD_HAS_PROCESS = 1U << 2,   // pid, start_time, process, user valid
+    RECORD_HAS_SOCKET = 1U << 3     // protocol, uid, inode, netns valid
+};
+
+constexpr uint8_t RECORD_PROTOCOL_UNKNOWN = 0xFF;
+
+struct BinaryRecord {
+    uint16_t port;
+    uint8_t protocol;       // platform::Protocol value or RECORD_PROTOCOL_UNKNOWN
+    uint8_t flags;          // BinaryRecordFlag bits
+    uint32_t pid;
+    uint32_t uid;
+    uint32_t reserved;
+    uint64_t inode;
+    uint64_t netns;
+    uint64_t start_time;    // Unix seconds, 0 if unknown
+    char process[32];
+    char user[24];
+};
+
+static_assert(sizeof(BinaryHeader) == 16, "BinaryHeader layout changed");
+static_assert(sizeof(BinaryRecord) == 96, "BinaryRecord layout changed");
+
+} // namespace zohd
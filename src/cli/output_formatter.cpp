@@ -1,10 +1,24 @@
 #include "output_formatter.hpp"
+#include "output_writer.hpp"
+#include "binary_record.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <ctime>
 #include <sstream>
+#include <unordered_set>
 
 namespace zohd {
 
+// "ipv4", "ipv6" or "unix"
+static const char* family_name(platform::Protocol protocol, bool ipv6) {
+    if (protocol == platform::Protocol::UNIX) return "unix";
+    return ipv6 ? "ipv6" : "ipv4";
+}
+
 void OutputFormatter::print_scan_results(const std::vector<PortInfo>& results) {
     std::cout << "Scanning common development ports...\n\n";
 
@@ -73,6 +87,46 @@ void OutputFormatter::print_detailed_info(const PortInfo& info) {
     }
 }
 
+void OutputFormatter::print_port_summary(const std::vector<PortInfo>& results) {
+    size_t busy_count = 0;
+
+    // One line per busy port; free ports are folded into ranges
+    for (const auto& info : results) {
+        if (info.is_free()) continue;
+
+        std::cout << status_symbol(info.status) << " "
+                  << std::setw(5) << info.port << " - USED by "
+                  << (info.process ? info.process->name : "unknown")
+                  << " (PID " << (info.process ? std::to_string(info.process->pid) : "?") << ")\n";
+        busy_count++;
+    }
+
+    std::string free_runs = free_port_runs(results);
+    if (!free_runs.empty()) {
+        std::cout << status_symbol(PortStatus::FREE) << " FREE: " << free_runs << "\n";
+    }
+
+    std::cout << "\nSummary: " << busy_count << " of " << results.size()
+              << " ports in use\n";
+}
+
+void OutputFormatter::print_detailed_infos(const std::vector<PortInfo>& results) {
+    bool first = true;
+    for (const auto& info : results) {
+        if (info.is_free()) continue;
+
+        if (!first) std::cout << "\n";
+        print_detailed_info(info);
+        first = false;
+    }
+
+    std::string free_runs = free_port_runs(results);
+    if (!free_runs.empty()) {
+        if (!first) std::cout << "\n";
+        std::cout << "Free ports: " << free_runs << "\n";
+    }
+}
+
 void OutputFormatter::print_suggested_ports(const std::vector<uint16_t>& ports) {
     if (ports.empty()) {
         std::cout << "No free ports found in development ranges.\n";
@@ -128,6 +182,601 @@ void OutputFormatter::print_active_ports(const std::vector<PortInfo>& ports) {
     std::cout << "\nTotal: " << ports.size() << " active ports\n";
 }
 
+void OutputFormatter::print_active_sockets(const platform::SocketTable& table) {
+    if (table.empty()) {
+        std::cout << "No active ports found.\n";
+        return;
+    }
+
+    size_t port_count = 0;
+    size_t unix_count = 0;
+    bool show_netns = false;
+    for (size_t row = 0; row < table.size(); row++) {
+        if (table.protocol(row) == platform::Protocol::UNIX) {
+            unix_count++;
+        } else {
+            port_count++;
+        }
+        show_netns = show_netns || table.netns(row) != 0;
+    }
+
+    // Namespace and container columns (--all-netns)
+    auto netns_header = [show_netns]() {
+        if (show_netns) {
+            std::cout << std::setw(12) << "NETNS" << std::setw(14) << "CONTAINER";
+        }
+    };
+    auto netns_columns = [show_netns, &table](size_t row) {
+        if (show_netns) {
+            std::string_view container = table.container(row);
+            std::cout << std::setw(12) << table.netns(row)
+                      << std::setw(14) << (container.empty() ? "-" : container);
+        }
+    };
+    size_t netns_width = show_netns ? 26 : 0;
+
+    if (port_count > 0) {
+        std::cout << "Active ports:\n";
+        std::cout << std::left
+                  << std::setw(8) << "PORT"
+                  << std::setw(9) << "PROTO";
+        netns_header();
+        std::cout << std::setw(8) << "PID"
+                  << std::setw(20) << "PROCESS"
+                  << std::setw(30) << "COMMAND"
+                  << "USER\n";
+        std::cout << std::string(89 + netns_width, '-') << "\n";
+
+        for (size_t row = 0; row < table.size(); row++) {
+            const platform::ProcessRecord* process = table.process(row);
+            if (table.protocol(row) == platform::Protocol::UNIX || !process) continue;
+
+            std::string proto = platform::protocol_name(table.protocol(row));
+            if (table.ipv6(row)) proto += "6";
+
+            std::cout << std::left
+                      << std::setw(8) << table.port(row)
+                      << std::setw(9) << proto;
+            netns_columns(row);
+            std::cout << std::setw(8) << process->pid
+                      << std::setw(20) << process->name.substr(0, 19)
+                      << std::setw(30) << process->command_line.substr(0, 29)
+                      << process->user << "\n";
+        }
+    }
+
+    if (unix_count > 0) {
+        if (port_count > 0) std::cout << "\n";
+        std::cout << "Unix sockets:\n";
+        std::cout << std::left
+                  << std::setw(40) << "PATH";
+        netns_header();
+        std::cout << std::setw(8) << "PID"
+                  << std::setw(20) << "PROCESS"
+                  << "USER\n";
+        std::cout << std::string(80 + netns_width, '-') << "\n";
+
+        for (size_t row = 0; row < table.size(); row++) {
+            const platform::ProcessRecord* process = table.process(row);
+            if (table.protocol(row) != platform::Protocol::UNIX || !process) continue;
+
+            std::string_view full_path = table.path(row);
+            std::string path = full_path.size() > 39
+                ? "..." + std::string(full_path.substr(full_path.size() - 36))
+                : std::string(full_path);
+
+            std::cout << std::left
+                      << std::setw(40) << path;
+            netns_columns(row);
+            std::cout << std::setw(8) << process->pid
+                      << std::setw(20) << process->name.substr(0, 19)
+                      << process->user << "\n";
+        }
+    }
+
+    std::cout << "\nTotal: " << port_count << " active ports";
+    if (unix_count > 0) std::cout << ", " << unix_count << " unix sockets";
+    std::cout << "\n";
+}
+
+void OutputFormatter::print_socket_groups(const platform::SocketTable& table,
+                                          const std::vector<platform::SocketGroup>& groups) {
+    bool first = true;
+    for (const auto& group : groups) {
+        size_t row = group.front();
+        std::string address = platform::address_string(table.address(row), table.ipv6(row));
+        if (table.ipv6(row)) address = "[" + address + "]";
+
+        uint64_t total_queue = 0;
+        std::unordered_set<uint32_t> pids;
+        for (size_t member : group) {
+            total_queue += table.rx_queue(member);
+            for (size_t i = 0; i < table.holder_count(member); i++) {
+                pids.insert(table.holder(member, i).pid);
+            }
+        }
+
+        if (!first) std::cout << "\n";
+        first = false;
+        std::cout << platform::protocol_name(table.protocol(row)) << " "
+                  << address << ":" << table.port(row) << "  "
+                  << group.size() << (group.size() == 1 ? " socket, " : " sockets, ")
+                  << pids.size() << (pids.size() == 1 ? " process" : " processes")
+                  << ", Recv-Q " << total_queue << "\n";
+        std::cout << "    " << std::left
+                  << std::setw(8) << "PID"
+                  << std::setw(20) << "PROCESS"
+                  << std::setw(12) << "INODE"
+                  << std::setw(8) << "RECV-Q"
+                  << "SHARE\n";
+
+        for (size_t member : group) {
+            const platform::ProcessRecord* process = table.process(member);
+            uint32_t queue = table.rx_queue(member);
+
+            std::cout << "    " << std::left
+                      << std::setw(8) << (process ? std::to_string(process->pid) : "-")
+                      << std::setw(20) << (process ? process->name.substr(0, 19) : "-")
+                      << std::setw(12) << table.inode(member)
+                      << std::setw(8) << queue;
+            if (total_queue > 0) {
+                std::cout << (uint64_t{queue} * 100 + total_queue / 2) / total_queue << "%";
+            } else {
+                std::cout << "-";
+            }
+            std::cout << "\n";
+
+            // Other holders of the same socket, e.g. preforked workers; the
+            // queue is the socket's, so it is not repeated
+            for (size_t i = 1; i < table.holder_count(member); i++) {
+                const platform::ProcessRecord& holder = table.holder(member, i);
+                std::cout << "    " << std::left
+                          << std::setw(8) << holder.pid
+                          << std::setw(20) << holder.name.substr(0, 19)
+                          << table.inode(member) << "\n";
+            }
+        }
+    }
+}
+
+void OutputFormatter::print_watch_events(const std::vector<WatchEvent>& events) {
+    if (events.empty()) return;
+
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // One JSON object per line, flushed together at the end of the poll
+    OutputWriter out;
+    for (const auto& event : events) {
+        const char* type = "opened";
+        if (event.type == WatchEvent::Type::CLOSED) type = "closed";
+        if (event.type == WatchEvent::Type::OWNER_CHANGED) type = "owner-changed";
+
+        out.text("{\"ts\":").number(static_cast<uint64_t>(now))
+           .text(",\"event\":\"").text(type).ch('"')
+           .text(",\"proto\":\"").text(platform::protocol_name(event.socket.protocol)).ch('"')
+           .text(",\"port\":").number(event.socket.port)
+           .text(",\"family\":\"").text(family_name(event.socket.protocol, event.socket.ipv6)).ch('"');
+        if (event.socket.protocol == platform::Protocol::UNIX) {
+            out.text(",\"path\":").json_string(event.socket.path);
+        }
+        if (event.socket.netns != 0) {
+            out.text(",\"netns\":").number(event.socket.netns);
+        }
+        out.text(",\"inode\":").number(event.socket.inode)
+           .text(",\"uid\":").number(event.socket.uid);
+        if (event.type != WatchEvent::Type::CLOSED) {
+            out.text(",\"pid\":").number(event.pid);
+        }
+        if (event.type != WatchEvent::Type::OPENED) {
+            out.text(",\"previous_pid\":").number(event.previous_pid);
+        }
+        out.text(",\"process\":").json_string(event.process).text("}\n");
+    }
+}
+
+void OutputFormatter::print_connection_stats(const std::vector<PortConnections>& ports,
+                                             uint64_t sockets, double sample_ms, size_t rows) {
+    using platform::TcpState;
+
+    std::vector<const PortConnections*> order;
+    order.reserve(ports.size());
+    for (const auto& port : ports) order.push_back(&port);
+    std::sort(order.begin(), order.end(), [](const PortConnections* a, const PortConnections* b) {
+        if (a->connections() != b->connections()) return a->connections() > b->connections();
+        return a->port < b->port;
+    });
+    if (rows != 0 && order.size() > rows) order.resize(rows);
+
+    std::time_t now = std::time(nullptr);
+    char clock[16];
+    std::strftime(clock, sizeof(clock), "%H:%M:%S", std::localtime(&now));
+    std::cout << "zohd top - " << clock << "  " << ports.size() << " listening ports, "
+              << sockets << " TCP sockets, sampled in " << std::fixed << std::setprecision(1)
+              << sample_ms << " ms\n\n";
+
+    std::cout << std::left
+              << std::setw(7) << "PORT"
+              << std::setw(7) << "LISTEN"
+              << std::setw(8) << "ESTAB"
+              << std::setw(9) << "SYN-RECV"
+              << std::setw(9) << "FIN-WAIT"
+              << std::setw(10) << "TIME-WAIT"
+              << std::setw(11) << "CLOSE-WAIT"
+              << std::setw(7) << "OTHER"
+              << std::setw(11) << "RECV-Q"
+              << std::setw(11) << "SEND-Q"
+              << "PEERS\n";
+
+    for (const PortConnections* port : order) {
+        uint32_t fin_wait = port->count(TcpState::FIN_WAIT1) + port->count(TcpState::FIN_WAIT2);
+        uint32_t other = port->connections() - port->count(TcpState::ESTABLISHED) -
+                         port->count(TcpState::SYN_RECV) - fin_wait -
+                         port->count(TcpState::TIME_WAIT) - port->count(TcpState::CLOSE_WAIT);
+        std::string peers = std::to_string(port->peers.estimate());
+        if (port->peers.saturated()) peers = ">" + peers;
+
+        std::cout << std::left
+                  << std::setw(7) << port->port
+                  << std::setw(7) << port->count(TcpState::LISTEN)
+                  << std::setw(8) << port->count(TcpState::ESTABLISHED)
+                  << std::setw(9) << port->count(TcpState::SYN_RECV)
+                  << std::setw(9) << fin_wait
+                  << std::setw(10) << port->count(TcpState::TIME_WAIT)
+                  << std::setw(11) << port->count(TcpState::CLOSE_WAIT)
+                  << std::setw(7) << other
+                  << std::setw(11) << port->rx_queue
+                  << std::setw(11) << port->tx_queue
+                  << peers << "\n";
+    }
+    std::cout.flush();
+}
+
+void OutputFormatter::print_ephemeral_report(const EphemeralReport& report, size_t rows) {
+    using platform::TcpState;
+
+    const auto& range = report.range;
+    uint32_t span = static_cast<uint32_t>(range.last - range.first) + 1;
+    std::cout << "Ephemeral range: " << range.first << "-" << range.last << ", "
+              << report.usable << " usable ports";
+    if (report.usable != span) std::cout << " (" << span - report.usable << " reserved)";
+    std::cout << "\n";
+    if (report.listening > 0) {
+        std::cout << "Listeners on range ports: " << report.listening << "\n";
+    }
+
+    double share = report.usable > 0 ? 100.0 * static_cast<double>(report.sockets) / report.usable : 0;
+    std::cout << "Outbound TCP sockets: " << report.sockets << " ("
+              << std::fixed << std::setprecision(1) << share << "% of the range)\n";
+    if (report.sockets == 0) return;
+
+    std::cout << " ";
+    for (size_t state = 0; state < report.states.size(); state++) {
+        if (report.states[state] == 0) continue;
+        std::cout << " " << platform::tcp_state_name(static_cast<TcpState>(state))
+                  << " " << report.states[state];
+    }
+    std::cout << "\n\n";
+
+    std::cout << std::left
+              << std::setw(46) << "DESTINATION"
+              << std::setw(9) << "SOCKETS"
+              << std::setw(11) << "TIME-WAIT"
+              << std::setw(10) << "HEADROOM"
+              << "USED\n";
+    size_t shown = 0;
+    for (const auto& destination : report.destinations) {
+        if (rows != 0 && shown++ == rows) break;
+
+        std::string address = platform::address_string(destination.address, destination.ipv6);
+        if (destination.ipv6) address = "[" + address + "]";
+        uint32_t used = report.usable - std::min(destination.headroom, report.usable);
+
+        std::cout << std::left
+                  << std::setw(46) << address + ":" + std::to_string(destination.port)
+                  << std::setw(9) << destination.sockets
+                  << std::setw(11) << destination.time_wait
+                  << std::setw(10) << destination.headroom
+                  << (report.usable > 0 ? (100 * used + report.usable / 2) / report.usable : 100)
+                  << "%\n";
+    }
+
+    std::cout << "\n" << std::left
+              << std::setw(8) << "PID"
+              << std::setw(20) << "PROCESS"
+              << "SOCKETS\n";
+    for (const auto& consumer : report.consumers) {
+        std::cout << std::left
+                  << std::setw(8) << (consumer.pid != 0 ? std::to_string(consumer.pid) : "-")
+                  << std::setw(20) << (consumer.pid != 0 ? consumer.name.substr(0, 19) : "(no owner)")
+                  << consumer.sockets << "\n";
+    }
+}
+
+// "address:port" of a listener, IPv6 in brackets
+static std::string listener_address(const platform::SocketEntry& socket) {
+    std::string address = platform::address_string(socket.address, socket.ipv6);
+    if (socket.ipv6) address = "[" + address + "]";
+    return address + ":" + std::to_string(socket.port);
+}
+
+// "37%", or "-" without a known backlog
+static std::string fill_text(const ListenerQueue& queue) {
+    double fill = queue.fill();
+    return fill < 0 ? "-" : std::to_string(std::lround(fill)) + "%";
+}
+
+void OutputFormatter::print_listener_queues(const std::vector<ListenerQueue>& queues) {
+    if (queues.empty()) {
+        std::cout << "No listening TCP sockets\n";
+        return;
+    }
+
+    std::cout << std::left
+              << std::setw(48) << "LISTENER"
+              << std::setw(8) << "QUEUE"
+              << std::setw(9) << "BACKLOG"
+              << std::setw(7) << "FILL"
+              << std::setw(8) << "PID"
+              << "PROCESS\n";
+
+    bool unknown = false;
+    for (const auto& queue : queues) {
+        const auto& socket = queue.socket;
+        unknown = unknown || socket.backlog < 0;
+        std::cout << std::left
+                  << std::setw(48) << listener_address(socket)
+                  << std::setw(8) << socket.rx_queue
+                  << std::setw(9) << (socket.backlog < 0 ? "-" : std::to_string(socket.backlog))
+                  << std::setw(7) << fill_text(queue)
+                  << std::setw(8) << (queue.pid != 0 ? std::to_string(queue.pid) : "-")
+                  << (queue.pid != 0 ? queue.process : "-") << "\n";
+    }
+    if (unknown) {
+        std::cout << "\nBacklog limits are only reported by the netlink backend\n";
+    }
+}
+
+void OutputFormatter::print_backlog_alerts(const std::vector<ListenerQueue>& queues) {
+    std::time_t now = std::time(nullptr);
+    char clock[16];
+    std::strftime(clock, sizeof(clock), "%H:%M:%S", std::localtime(&now));
+
+    for (const auto& queue : queues) {
+        std::cout << clock << "  SATURATED  " << listener_address(queue.socket)
+                  << "  queue " << queue.socket.rx_queue << "/" << queue.socket.backlog
+                  << " (" << fill_text(queue) << ")";
+        if (queue.pid != 0) std::cout << "  pid " << queue.pid << " " << queue.process;
+        std::cout << "\n";
+    }
+}
+
+void OutputFormatter::write_ports(const std::vector<PortInfo>& results, OutputFormat format) {
+    write_records(results.size(), [&results](size_t i) {
+        const PortInfo& info = results[i];
+        Record record;
+        record.port = info.port;
+        record.in_use = info.is_in_use();
+        if (info.process) {
+            record.has_process = true;
+            record.pid = info.process->pid;
+            record.name = info.process->name;
+            record.command_line = info.process->command_line;
+            record.user = info.process->user;
+            record.start_time = info.process->start_time;
+        }
+        return record;
+    }, format);
+}
+
+void OutputFormatter::write_sockets(const platform::SocketTable& table, OutputFormat format) {
+    write_records(table.size(), [&table](size_t row) {
+        Record record;
+        record.port = table.port(row);
+        record.in_use = true;
+        record.has_socket = true;
+        record.protocol = table.protocol(row);
+        record.ipv6 = table.ipv6(row);
+        record.uid = table.uid(row);
+        record.inode = table.inode(row);
+        record.netns = table.netns(row);
+        record.address = table.address(row);
+        record.rx_queue = table.rx_queue(row);
+        record.tx_queue = table.tx_queue(row);
+        record.path = table.path(row);
+        record.container = table.container(row);
+        if (const platform::ProcessRecord* process = table.process(row)) {
+            record.has_process = true;
+            record.pid = process->pid;
+            record.name = process->name;
+            record.command_line = process->command_line;
+            record.user = process->user;
+            record.start_time = process->start_time;
+        }
+        return record;
+    }, format);
+}
+
+void OutputFormatter::write_records(size_t count, const std::function<Record(size_t)>& record_at,
+                                    OutputFormat format) {
+    OutputWriter out;
+
+    switch (format) {
+        case OutputFormat::JSON:
+            out.ch('[');
+            for (size_t i = 0; i < count; i++) {
+                out.text(i == 0 ? "\n  " : ",\n  ");
+                write_json_record(out, record_at(i));
+            }
+            out.text(count == 0 ? "]\n" : "\n]\n");
+            break;
+
+        case OutputFormat::JSONL:
+            for (size_t i = 0; i < count; i++) {
+                write_json_record(out, record_at(i));
+                out.ch('\n');
+            }
+            break;
+
+        case OutputFormat::CSV:
+            out.text("port,status,proto,family,uid,inode,path,netns,container,"
+                     "pid,process,command,user,start_time,address,rx_queue,tx_queue\n");
+            for (size_t i = 0; i < count; i++) {
+                write_csv_record(out, record_at(i));
+            }
+            break;
+
+        case OutputFormat::BIN: {
+            BinaryHeader header{};
+            std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+            header.version = BINARY_VERSION;
+            header.record_size = sizeof(BinaryRecord);
+            header.record_count = static_cast<uint32_t>(count);
+            header.byte_order = BINARY_BYTE_ORDER;
+            out.bytes(&header, sizeof(header));
+            for (size_t i = 0; i < count; i++) {
+                write_binary_record(out, record_at(i));
+            }
+            break;
+        }
+
+        case OutputFormat::TEXT:
+            break;
+    }
+}
+
+void OutputFormatter::write_json_record(OutputWriter& out, const Record& record) {
+    out.text("{\"port\":").number(record.port)
+       .text(",\"status\":\"").text(record.in_use ? "in_use" : "free").ch('"');
+
+    if (record.has_socket) {
+        out.text(",\"proto\":\"").text(platform::protocol_name(record.protocol)).ch('"')
+           .text(",\"family\":\"").text(family_name(record.protocol, record.ipv6)).ch('"')
+           .text(",\"uid\":").number(record.uid)
+           .text(",\"inode\":").number(record.inode);
+        if (record.protocol == platform::Protocol::UNIX) {
+            out.text(",\"path\":").json_string(record.path);
+        } else {
+            out.text(",\"address\":\"").text(platform::address_string(record.address, record.ipv6))
+               .text("\",\"rx_queue\":").number(record.rx_queue)
+               .text(",\"tx_queue\":").number(record.tx_queue);
+        }
+        if (record.netns != 0) {
+            out.text(",\"netns\":").number(record.netns);
+        }
+        if (!record.container.empty()) {
+            out.text(",\"container\":").json_string(record.container);
+        }
+    }
+
+    if (record.has_process) {
+        out.text(",\"pid\":").number(record.pid)
+           .text(",\"process\":").json_string(record.name);
+        if (!record.command_line.empty()) {
+            out.text(",\"command\":").json_string(record.command_line);
+        }
+        if (!record.user.empty()) {
+            out.text(",\"user\":").json_string(record.user);
+        }
+        if (record.start_time > 0) {
+            out.text(",\"start_time\":").number(record.start_time);
+        }
+    }
+
+    out.ch('}');
+}
+
+void OutputFormatter::write_csv_record(OutputWriter& out, const Record& record) {
+    out.number(record.port).ch(',').text(record.in_use ? "in_use" : "free").ch(',');
+
+    if (record.has_socket) {
+        out.text(platform::protocol_name(record.protocol)).ch(',')
+           .text(family_name(record.protocol, record.ipv6)).ch(',')
+           .number(record.uid).ch(',')
+           .number(record.inode).ch(',')
+           .csv_field(record.path).ch(',');
+        if (record.netns != 0) out.number(record.netns);
+        out.ch(',');
+        out.csv_field(record.container);
+        out.ch(',');
+    } else {
+        out.text(",,,,,,,");
+    }
+
+    if (record.has_process) {
+        out.number(record.pid).ch(',')
+           .csv_field(record.name).ch(',')
+           .csv_field(record.command_line).ch(',')
+           .csv_field(record.user).ch(',');
+        if (record.start_time > 0) out.number(record.start_time);
+    } else {
+        out.text(",,,,");
+    }
+
+    if (record.has_socket && record.protocol != platform::Protocol::UNIX) {
+        out.ch(',').text(platform::address_string(record.address, record.ipv6))
+           .ch(',').number(record.rx_queue)
+           .ch(',').number(record.tx_queue);
+    } else {
+        out.text(",,,");
+    }
+
+    out.ch('\n');
+}
+
+void OutputFormatter::write_binary_record(OutputWriter& out, const Record& record) {
+    BinaryRecord row{};
+    row.port = record.port;
+    row.protocol = RECORD_PROTOCOL_UNKNOWN;
+    if (record.in_use) row.flags |= RECORD_IN_USE;
+
+    if (record.has_socket) {
+        row.flags |= RECORD_HAS_SOCKET;
+        if (record.ipv6) row.flags |= RECORD_IPV6;
+        row.protocol = static_cast<uint8_t>(record.protocol);
+        row.uid = record.uid;
+        row.inode = record.inode;
+        row.netns = record.netns;
+    }
+
+    if (record.has_process) {
+        row.flags |= RECORD_HAS_PROCESS;
+        row.pid = record.pid;
+        row.start_time = record.start_time;
+        // Leave the last byte as the NUL terminator
+        std::memcpy(row.process, record.name.data(),
+                    std::min(record.name.size(), sizeof(row.process) - 1));
+        std::memcpy(row.user, record.user.data(),
+                    std::min(record.user.size(), sizeof(row.user) - 1));
+    }
+
+    out.bytes(&row, sizeof(row));
+}
+
+// "3000, 8000-8079, 8081-8090": consecutive free ports as ranges, in input order
+std::string OutputFormatter::free_port_runs(const std::vector<PortInfo>& results) {
+    std::string runs;
+    size_t i = 0;
+    while (i < results.size()) {
+        if (!results[i].is_free()) {
+            i++;
+            continue;
+        }
+
+        size_t j = i;
+        while (j + 1 < results.size() && results[j + 1].is_free() &&
+               results[j + 1].port == results[j].port + 1) {
+            j++;
+        }
+
+        if (!runs.empty()) runs += ", ";
+        runs += std::to_string(results[i].port);
+        if (j > i) runs += "-" + std::to_string(results[j].port);
+        i = j + 1;
+    }
+    return runs;
+}
+
 std::string OutputFormatter::status_symbol(PortStatus status) {
     switch(status) {
         case PortStatus::FREE: return "✓";
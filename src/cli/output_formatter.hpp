@@ -1,22 +1,94 @@
 #pragma once
 
 #include "../core/port_info.hpp"
+#include "../core/port_watcher.hpp"
+#include "../core/connection_stats.hpp"
+#include "../core/ephemeral_ports.hpp"
+#include "../core/accept_queue.hpp"
+#include "../platform/platform_interface.hpp"
+#include "../platform/socket_table.hpp"
+#include <array>
+#include <functional>
+#include <string_view>
 #include <vector>
 #include <iostream>
 
 namespace zohd {
 
+class OutputWriter;
+
+// --format: human-readable table or a machine-readable stream
+enum class OutputFormat {
+    TEXT,
+    JSON,    // One array of objects
+    JSONL,   // One object per line
+    CSV,     // Header row plus one row per record
+    BIN      // Fixed-size records, see binary_record.hpp
+};
+
 class OutputFormatter {
 public:
     static void print_scan_results(const std::vector<PortInfo>& results);
     static void print_port_info(const PortInfo& info);
     static void print_detailed_info(const PortInfo& info);
+    static void print_port_summary(const std::vector<PortInfo>& results);
+    static void print_detailed_infos(const std::vector<PortInfo>& results);
     static void print_suggested_ports(const std::vector<uint16_t>& ports);
     static void print_active_ports(const std::vector<PortInfo>& ports);
+    static void print_active_sockets(const platform::SocketTable& table);
+    // One block per group: every owner and its socket's receive queue
+    static void print_socket_groups(const platform::SocketTable& table,
+                                    const std::vector<platform::SocketGroup>& groups);
+    static void print_watch_events(const std::vector<WatchEvent>& events);
+    // One `zohd top` frame: the busiest `rows` ports (0 = all)
+    static void print_connection_stats(const std::vector<PortConnections>& ports,
+                                       uint64_t sockets, double sample_ms, size_t rows);
+    // Range, outbound sockets by state, then the top `rows` destinations
+    static void print_ephemeral_report(const EphemeralReport& report, size_t rows);
+    // Accept queue against backlog for each listener, in the given order
+    static void print_listener_queues(const std::vector<ListenerQueue>& queues);
+    // One timestamped line per listener over the --threshold
+    static void print_backlog_alerts(const std::vector<ListenerQueue>& queues);
+
+    // Machine-readable output (any format except TEXT)
+    static void write_ports(const std::vector<PortInfo>& results, OutputFormat format);
+    static void write_sockets(const platform::SocketTable& table, OutputFormat format);
 
 private:
     static std::string status_symbol(PortStatus status);
     static std::string format_uptime(uint64_t start_time);
+    static std::string free_port_runs(const std::vector<PortInfo>& results);
+
+    // Common row behind write_ports() and write_sockets(). Built one at a
+    // time; the views point into the caller's results.
+    struct Record {
+        uint16_t port = 0;
+        bool in_use = false;
+
+        bool has_socket = false;  // Unknown for PortInfo rows
+        platform::Protocol protocol = platform::Protocol::TCP;
+        bool ipv6 = false;
+        uint32_t uid = 0;
+        unsigned long inode = 0;
+        uint64_t netns = 0;
+        std::array<uint32_t, 4> address{};
+        uint32_t rx_queue = 0;
+        uint32_t tx_queue = 0;
+        std::string_view path;
+        std::string_view container;
+
+        bool has_process = false;
+        uint32_t pid = 0;
+        std::string_view name;
+        std::string_view command_line;
+        std::string_view user;
+        uint64_t start_time = 0;
+    };
+    static void write_records(size_t count, const std::function<Record(size_t)>& record_at,
+                              OutputFormat format);
+    static void write_json_record(OutputWriter& out, const Record& record);
+    static void write_csv_record(OutputWriter& out, const Record& record);
+    static void write_binary_record(OutputWriter& out, const Record& record);
 };
 
 } // namespace zohd
@@ -0,0 +1,118 @@
+#include "output_writer.hpp"
+#include "../core/profiler.hpp"
+#include <cerrno>
+#include <charconv>
+#include <iostream>
+
+#ifdef PLATFORM_WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace zohd {
+
+OutputWriter::OutputWriter(int fd, size_t capacity)
+    : fd_(fd), capacity_(capacity) {
+    buffer_.reserve(capacity_);
+    std::cout.flush();
+}
+
+OutputWriter::~OutputWriter() {
+    flush();
+}
+
+OutputWriter& OutputWriter::text(std::string_view text) {
+    if (text.size() > capacity_) {
+        flush();
+        buffer_.append(text);
+        flush();
+        return *this;
+    }
+    reserve(text.size());
+    buffer_.append(text);
+    return *this;
+}
+
+OutputWriter& OutputWriter::ch(char c) {
+    reserve(1);
+    buffer_.push_back(c);
+    return *this;
+}
+
+OutputWriter& OutputWriter::number(uint64_t value) {
+    char digits[20];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    reserve(result.ptr - digits);
+    buffer_.append(digits, result.ptr);
+    return *this;
+}
+
+OutputWriter& OutputWriter::json_string(std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+
+    // Worst case every byte becomes \u00XX
+    reserve(text.size() * 6 + 2);
+    buffer_.push_back('"');
+    for (char c : text) {
+        switch (c) {
+            case '"': buffer_ += "\\\""; break;
+            case '\\': buffer_ += "\\\\"; break;
+            case '\n': buffer_ += "\\n"; break;
+            case '\t': buffer_ += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    buffer_ += "\\u00";
+                    buffer_.push_back(hex[(c >> 4) & 0xF]);
+                    buffer_.push_back(hex[c & 0xF]);
+                } else {
+                    buffer_.push_back(c);
+                }
+        }
+    }
+    buffer_.push_back('"');
+    return *this;
+}
+
+OutputWriter& OutputWriter::csv_field(std::string_view text) {
+    if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+        return this->text(text);
+    }
+
+    reserve(text.size() * 2 + 2);
+    buffer_.push_back('"');
+    for (char c : text) {
+        if (c == '"') buffer_.push_back('"');
+        buffer_.push_back(c);
+    }
+    buffer_.push_back('"');
+    return *this;
+}
+
+OutputWriter& OutputWriter::bytes(const void* data, size_t size) {
+    return text(std::string_view(static_cast<const char*>(data), size));
+}
+
+void OutputWriter::flush() {
+    const char* data = buffer_.data();
+    size_t left = buffer_.size();
+
+    while (left > 0) {
+#ifdef PLATFORM_WINDOWS
+        auto written = _write(fd_, data, static_cast<unsigned>(left));
+#else
+        auto written = ::write(fd_, data, left);
+#endif
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            break;  // Reader went away (EPIPE); drop the rest
+        }
+        profiler::count(profiler::BYTES_WRITTEN, static_cast<uint64_t>(written));
+        data += written;
+        left -= static_cast<size_t>(written);
+    }
+
+    buffer_.clear();
+}
+
+} // namespace zohd
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace zohd {
+
+// Output sink that assembles text in one large buffer and hands it to the
+// kernel with few write() calls. Flushes when the buffer fills up and on
+// destruction. std::cout is flushed first so earlier output stays in order.
+class OutputWriter {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 256 * 1024;
+
+    explicit OutputWriter(int fd = 1, size_t capacity = DEFAULT_CAPACITY);
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    OutputWriter& text(std::string_view text);
+    OutputWriter& ch(char c);
+    OutputWriter& number(uint64_t value);
+
+    // Quoted JSON string with escapes
+    OutputWriter& json_string(std::string_view text);
+
+    // CSV field, quoted only when it contains a separator, quote or newline
+    OutputWriter& csv_field(std::string_view text);
+
+    // Raw bytes (binary records)
+    OutputWriter& bytes(const void* data, size_t size);
+
+    void flush();
+
+private:
+    // Make room for `size` more bytes, flushing if the buffer would overflow
+    void reserve(size_t size) {
+        if (buffer_.size() + size > capacity_) flush();
+    }
+
+    int fd_;
+    size_t capacity_;
+    std::string buffer_;
+};
+
+} // namespace zohd
@@ -0,0 +1,79 @@
+#include "accept_queue.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace zohd {
+
+using platform::Protocol;
+using platform::SocketEntry;
+
+double queue_fill(const SocketEntry& listener) {
+    if (listener.backlog < 0) return -1;
+    // listen(fd, 0) still admits one connection
+    int32_t limit = std::max<int32_t>(listener.backlog, 1);
+    return listener.rx_queue * 100.0 / limit;
+}
+
+AcceptQueueSampler::AcceptQueueSampler(const std::vector<uint16_t>& ports) {
+    if (ports.empty()) return;
+    watched_.assign(65536, false);
+    for (uint16_t port : ports) watched_[port] = true;
+    if (std::all_of(ports.begin(), ports.end(), [&](uint16_t port) { return port == ports[0]; })) {
+        only_port_ = ports[0];
+    }
+}
+
+const std::vector<SocketEntry>& AcceptQueueSampler::sample() {
+    profiler::Phase phase("accept_queues");
+    listeners_ = platform::get_sockets(platform::protocol_bit(Protocol::TCP), only_port_);
+    if (!watched_.empty()) {
+        listeners_.erase(std::remove_if(listeners_.begin(), listeners_.end(),
+                                        [this](const SocketEntry& entry) {
+                                            return !watched_[entry.port];
+                                        }),
+                         listeners_.end());
+    }
+    return listeners_;
+}
+
+std::vector<ListenerQueue> resolve_listener_owners(const std::vector<SocketEntry>& sockets) {
+    std::vector<unsigned long> inodes;
+    inodes.reserve(sockets.size());
+    for (const auto& socket : sockets) inodes.push_back(socket.inode);
+    auto owners = platform::find_socket_owners(inodes);
+
+    // SO_REUSEPORT groups often share one process; read its name once
+    std::unordered_map<uint32_t, std::string> names;
+    std::vector<ListenerQueue> result;
+    result.reserve(sockets.size());
+    for (const auto& socket : sockets) {
+        ListenerQueue queue;
+        queue.socket = socket;
+        auto it = owners.find(socket.inode);
+        if (it != owners.end()) {
+            queue.pid = it->second;
+            auto name = names.find(queue.pid);
+            if (name == names.end()) {
+                name = names.emplace(queue.pid, platform::get_process_info(
+                                                    queue.pid, platform::PROCESS_NAME).name).first;
+            }
+            queue.process = name->second;
+        }
+        result.push_back(std::move(queue));
+    }
+    return result;
+}
+
+std::vector<ListenerQueue> get_listener_queues(const std::vector<uint16_t>& ports) {
+    AcceptQueueSampler sampler(ports);
+    auto result = resolve_listener_owners(sampler.sample());
+    std::stable_sort(result.begin(), result.end(),
+                     [](const ListenerQueue& a, const ListenerQueue& b) {
+                         if (a.fill() != b.fill()) return a.fill() > b.fill();
+                         return a.socket.port < b.socket.port;
+                     });
+    return result;
+}
+
+} // namespace zohd
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../platform/platform_interface.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace zohd {
+
+// Accept queue length of a listener as a percentage of its backlog (above
+// 100 once the kernel drops connections), -1 if the backlog is unknown
+double queue_fill(const platform::SocketEntry& listener);
+
+// A TCP listener's accept queue: connections the kernel has completed and
+// that wait for the application to accept() them
+struct ListenerQueue {
+    platform::SocketEntry socket;  // rx_queue is the queue, backlog its limit
+    uint32_t pid = 0;              // 0 if the owner is not visible
+    std::string process;
+
+    double fill() const { return queue_fill(socket); }
+};
+
+// Listener queues read over and over, for `zohd backlog --threshold`. Each
+// sample() is one dump of listening TCP sockets only, filtered to one port
+// in the kernel when only one is watched; owners are not resolved.
+class AcceptQueueSampler {
+public:
+    // Watch `ports`, or every listener if empty
+    explicit AcceptQueueSampler(const std::vector<uint16_t>& ports);
+
+    // Current listeners of the watched ports. Valid until the next call.
+    const std::vector<platform::SocketEntry>& sample();
+
+private:
+    std::vector<bool> watched_;  // Indexed by port; empty = every port
+    uint16_t only_port_ = 0;     // Kernel-side filter when exactly one port is watched
+    std::vector<platform::SocketEntry> listeners_;
+};
+
+// Listeners of `ports` (every port if empty) with their owners, fullest first
+std::vector<ListenerQueue> get_listener_queues(const std::vector<uint16_t>& ports);
+
+// Owners for listeners already sampled
+std::vector<ListenerQueue> resolve_listener_owners(const std::vector<platform::SocketEntry>& sockets);
+
+} // namespace zohd
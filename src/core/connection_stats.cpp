@@ -0,0 +1,97 @@
+#include "connection_stats.hpp"
+#include "profiler.hpp"
+#include <bitset>
+#include <cmath>
+
+namespace zohd {
+
+using platform::TcpConnection;
+using platform::TcpState;
+
+namespace {
+
+uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+} // namespace
+
+void PeerCounter::add(const std::array<uint32_t, 4>& address) {
+    // IPv4 peers seen through a dual-stack listener count as the same host
+    // as plain IPv4 connections
+    auto key = address;
+    platform::unmap_ipv4(key);
+    uint64_t hash = mix((static_cast<uint64_t>(key[0]) << 32 | key[1]) ^
+                        mix(static_cast<uint64_t>(key[2]) << 32 | key[3]));
+    size_t bit = hash % BITS;
+    bits_[bit / 64] |= 1ull << (bit % 64);
+}
+
+uint32_t PeerCounter::estimate() const {
+    size_t set = 0;
+    for (uint64_t word : bits_) set += std::bitset<64>(word).count();
+    if (set == 0) return 0;
+
+    // n = -m ln(V), V the share of clear bits; with none clear, use one
+    size_t clear = BITS - set;
+    double share = static_cast<double>(clear == 0 ? 1 : clear) / BITS;
+    return static_cast<uint32_t>(std::lround(-static_cast<double>(BITS) * std::log(share)));
+}
+
+bool PeerCounter::saturated() const {
+    for (uint64_t word : bits_) {
+        if (word != ~0ull) return false;
+    }
+    return true;
+}
+
+uint32_t PortConnections::connections() const {
+    uint32_t total = 0;
+    for (size_t state = 0; state < states.size(); state++) {
+        if (state != static_cast<size_t>(TcpState::LISTEN)) total += states[state];
+    }
+    return total;
+}
+
+ConnectionAggregator::ConnectionAggregator() : slot_(65536, 0) {}
+
+const std::vector<PortConnections>& ConnectionAggregator::sample() {
+    profiler::Phase phase("aggregate");
+
+    for (const auto& port : ports_) slot_[port.port] = 0;
+    ports_.clear();  // Keeps the capacity for this sample
+    sockets_ = 0;
+
+    // Listeners come first, so every later row either belongs to a known
+    // listening port or is an outgoing connection and is skipped
+    platform::for_each_tcp_connection([this](const TcpConnection& row) {
+        sockets_++;
+        uint32_t& slot = slot_[row.local_port];
+
+        if (row.state == TcpState::LISTEN) {
+            if (slot == 0) {
+                ports_.emplace_back();
+                ports_.back().port = row.local_port;
+                slot = static_cast<uint32_t>(ports_.size());
+            }
+            ports_[slot - 1].states[static_cast<size_t>(TcpState::LISTEN)]++;
+            return;
+        }
+        if (slot == 0) return;
+
+        PortConnections& port = ports_[slot - 1];
+        port.states[static_cast<size_t>(row.state)]++;
+        port.rx_queue += row.rx_queue;
+        port.tx_queue += row.tx_queue;
+        port.peers.add(row.remote_address);
+    });
+
+    return ports_;
+}
+
+} // namespace zohd
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../platform/platform_interface.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace zohd {
+
+// Approximate count of distinct remote addresses by linear counting: each
+// address sets one bit of a fixed bitmap, and the share of bits still clear
+// gives the estimate. Accurate to a few percent up to a few thousand peers.
+class PeerCounter {
+public:
+    static constexpr size_t BITS = 1024;
+
+    void add(const std::array<uint32_t, 4>& address);
+    void clear() { bits_.fill(0); }
+
+    // Estimated distinct peers; a lower bound once saturated()
+    uint32_t estimate() const;
+    bool saturated() const;
+
+private:
+    std::array<uint64_t, BITS / 64> bits_{};
+};
+
+// Every TCP socket on one listening port, by state
+struct PortConnections {
+    uint16_t port = 0;
+    std::array<uint32_t, platform::TCP_STATE_COUNT> states{};  // Indexed by TcpState
+    uint64_t rx_queue = 0;  // Bytes, summed over the port's connections
+    uint64_t tx_queue = 0;
+    PeerCounter peers;
+
+    uint32_t count(platform::TcpState state) const {
+        return states[static_cast<size_t>(state)];
+    }
+
+    // Sockets other than the listeners
+    uint32_t connections() const;
+};
+
+// Per-port connection counters for `zohd top`. Each sample() makes one pass
+// over the TCP tables into fixed-size counters that are reused between
+// samples, so a steady host causes no allocation at all.
+class ConnectionAggregator {
+public:
+    ConnectionAggregator();
+
+    // Re-read the TCP tables. The result has one entry per listening port,
+    // in no particular order, and is valid until the next call.
+    const std::vector<PortConnections>& sample();
+
+    // Sockets seen by the last sample(), listeners included
+    uint64_t sockets() const { return sockets_; }
+
+private:
+    std::vector<PortConnections> ports_;
+    std::vector<uint32_t> slot_;  // Port -> index in ports_ + 1, 0 if not listening
+    uint64_t sockets_ = 0;
+};
+
+} // namespace zohd
@@ -0,0 +1,125 @@
+#include "ephemeral_ports.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace zohd {
+
+using platform::TcpConnection;
+using platform::TcpState;
+
+namespace {
+
+struct DestinationKey {
+    std::array<uint32_t, 4> address;
+    uint16_t port;
+    bool ipv6;
+
+    bool operator==(const DestinationKey& other) const {
+        return address == other.address && port == other.port && ipv6 == other.ipv6;
+    }
+};
+
+struct DestinationHash {
+    size_t operator()(const DestinationKey& key) const {
+        uint64_t hash = 1469598103934665603ull;
+        for (uint32_t word : key.address) hash = (hash ^ word) * 1099511628211ull;
+        return static_cast<size_t>((hash ^ (static_cast<uint64_t>(key.port) << 1 | key.ipv6)) *
+                                   1099511628211ull);
+    }
+};
+
+} // namespace
+
+EphemeralReport analyze_ephemeral_ports(size_t max_consumers) {
+    profiler::Phase phase("ephemeral");
+
+    EphemeralReport report;
+    report.range = platform::get_ephemeral_range();
+    report.usable = report.range.usable();
+
+    std::vector<bool> ephemeral(65536);
+    for (uint32_t port = report.range.first; port <= report.range.last; port++) {
+        ephemeral[port] = report.range.contains(static_cast<uint16_t>(port));
+    }
+
+    std::vector<bool> listening(65536);
+    std::unordered_map<DestinationKey, EphemeralDestination, DestinationHash> destinations;
+    std::vector<unsigned long> inodes;
+    uint32_t no_inode = 0;
+
+    // Listeners arrive first, so accepted connections on a listening port
+    // inside the range are recognised and skipped
+    platform::for_each_tcp_connection([&](const TcpConnection& row) {
+        if (row.state == TcpState::LISTEN) {
+            if (!listening[row.local_port]) {
+                listening[row.local_port] = true;
+                if (ephemeral[row.local_port]) report.listening++;
+            }
+            return;
+        }
+        if (!ephemeral[row.local_port] || listening[row.local_port]) return;
+
+        report.sockets++;
+        report.states[static_cast<size_t>(row.state)]++;
+
+        DestinationKey key{row.remote_address, row.remote_port, row.ipv6};
+        if (key.ipv6 && platform::unmap_ipv4(key.address)) key.ipv6 = false;
+
+        EphemeralDestination& destination = destinations[key];
+        destination.sockets++;
+        if (row.state == TcpState::TIME_WAIT) destination.time_wait++;
+
+        if (row.inode != 0) {
+            inodes.push_back(row.inode);
+        } else {
+            no_inode++;
+        }
+    });
+
+    uint32_t taken = report.listening;
+    report.destinations.reserve(destinations.size());
+    for (auto& [key, destination] : destinations) {
+        destination.address = key.address;
+        destination.ipv6 = key.ipv6;
+        destination.port = key.port;
+        uint32_t used = taken + destination.sockets;
+        destination.headroom = used < report.usable ? report.usable - used : 0;
+        report.destinations.push_back(destination);
+    }
+    std::sort(report.destinations.begin(), report.destinations.end(),
+              [](const EphemeralDestination& a, const EphemeralDestination& b) {
+                  return a.sockets > b.sockets;
+              });
+
+    // One shared /proc walk for every owner, then names for the largest only
+    std::unordered_map<uint32_t, uint32_t> per_pid;
+    auto owners = platform::find_socket_owners(inodes);
+    for (unsigned long inode : inodes) {
+        auto it = owners.find(inode);
+        per_pid[it == owners.end() ? 0 : it->second]++;
+    }
+    if (no_inode > 0) per_pid[0] += no_inode;
+
+    for (const auto& [pid, sockets] : per_pid) {
+        EphemeralConsumer consumer;
+        consumer.pid = pid;
+        consumer.sockets = sockets;
+        report.consumers.push_back(consumer);
+    }
+    std::sort(report.consumers.begin(), report.consumers.end(),
+              [](const EphemeralConsumer& a, const EphemeralConsumer& b) {
+                  return a.sockets > b.sockets;
+              });
+    if (report.consumers.size() > max_consumers) report.consumers.resize(max_consumers);
+
+    for (auto& consumer : report.consumers) {
+        if (consumer.pid != 0) {
+            consumer.name = platform::get_process_info(consumer.pid, platform::PROCESS_NAME).name;
+        }
+    }
+
+    return report;
+}
+
+} // namespace zohd
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../platform/platform_interface.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace zohd {
+
+// Outbound TCP sockets to one remote address and port. Every one of them
+// holds a distinct local port, so together they bound how many more
+// connections the kernel can make to that destination.
+struct EphemeralDestination {
+    std::array<uint32_t, 4> address{};
+    bool ipv6 = false;
+    uint16_t port = 0;
+    uint32_t sockets = 0;
+    uint32_t time_wait = 0;
+    uint32_t headroom = 0;  // Local ports still free for this destination
+};
+
+// A process holding outbound sockets
+struct EphemeralConsumer {
+    uint32_t pid = 0;  // 0: no visible owner (TIME_WAIT, other users)
+    std::string name;
+    uint32_t sockets = 0;
+};
+
+struct EphemeralReport {
+    platform::EphemeralRange range;
+    uint32_t usable = 0;          // range.usable()
+    uint32_t listening = 0;       // Range ports taken by listeners, unusable for any destination
+    uint64_t sockets = 0;         // Outbound sockets on range ports
+    std::array<uint32_t, platform::TCP_STATE_COUNT> states{};  // Of those, by TcpState
+    std::vector<EphemeralDestination> destinations;  // Most sockets first
+    std::vector<EphemeralConsumer> consumers;        // Most sockets first
+};
+
+// Read the ephemeral range and classify every TCP socket in one pass.
+// Sockets on ports with a listener are accepted connections, not outbound
+// ones. Owners are resolved for the `max_consumers` largest PIDs.
+EphemeralReport analyze_ephemeral_ports(size_t max_consumers = 10);
+
+} // namespace zohd
@@ -0,0 +1,510 @@
+#ifndef PLATFORM_WINDOWS
+
+#include "port_lease.hpp"
+#include "../platform/socket_snapshot.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace zohd {
+
+namespace {
+
+// socket() with close-on-exec set (SOCK_CLOEXEC is not portable)
+int open_socket(int domain, int type) {
+    int fd = socket(domain, type, 0);
+    if (fd >= 0) fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+}
+
+void set_nonblocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+sockaddr_un unix_address(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Lease socket path too long: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+sockaddr_in any_address(uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    return addr;
+}
+
+// Nothing holds `port` right now: a TCP bind() without SO_REUSEADDR
+// succeeds. The socket never listens, so closing it leaves no TIME_WAIT.
+bool bind_confirms_free(uint16_t port) {
+    int fd = open_socket(AF_INET, SOCK_STREAM);
+    if (fd < 0) return false;
+
+    sockaddr_in addr = any_address(port);
+    bool free = bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    close(fd);
+    return free;
+}
+
+// TCP socket bound to `port`, ready for the receiver to listen() on
+int bound_socket(uint16_t port) {
+    int fd = open_socket(AF_INET, SOCK_STREAM);
+    if (fd < 0) return -1;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = any_address(port);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Send `line`, attaching `pass_fd` as SCM_RIGHTS when it is >= 0
+bool send_line(int fd, const std::string& line, int pass_fd = -1) {
+    iovec iov{const_cast<char*>(line.data()), line.size()};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    if (pass_fd >= 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &pass_fd, sizeof(int));
+    }
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(fd, &msg, 0);
+    } while (sent < 0 && errno == EINTR);
+    return sent == static_cast<ssize_t>(line.size());
+}
+
+volatile sig_atomic_t g_stop = 0;
+
+void request_stop(int) {
+    g_stop = 1;
+}
+
+} // namespace
+
+std::string default_lease_socket_path() {
+    const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtime_dir && *runtime_dir) return std::string(runtime_dir) + "/zohd-lease.sock";
+    return "/tmp/zohd-lease-" + std::to_string(getuid()) + ".sock";
+}
+
+// -- Server --
+
+LeaseServer::LeaseServer(LeaseServerConfig config)
+    : config_(std::move(config)), busy_(65536 / 64, 0), cursor_(0) {}
+
+LeaseServer::~LeaseServer() {
+    for (const auto& [fd, client] : clients_) close(fd);
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        unlink(config_.socket_path.c_str());
+    }
+    if (lock_fd_ >= 0) close(lock_fd_);
+}
+
+bool LeaseServer::listen() {
+    // One daemon per path: whoever holds the lock owns the socket file, so
+    // a leftover file can be replaced without racing a live daemon
+    std::string lock_path = config_.socket_path + ".lock";
+    lock_fd_ = open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (lock_fd_ < 0) {
+        throw std::runtime_error("Cannot open " + lock_path + ": " + std::strerror(errno));
+    }
+    if (flock(lock_fd_, LOCK_EX | LOCK_NB) != 0) return false;
+
+    sockaddr_un addr = unix_address(config_.socket_path);
+    unlink(config_.socket_path.c_str());
+
+    int fd = open_socket(AF_UNIX, SOCK_STREAM);
+    mode_t old_mask = umask(077);
+    bool bound = fd >= 0 && bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    umask(old_mask);
+    if (!bound || ::listen(fd, SOMAXCONN) != 0) {
+        std::string reason = std::strerror(errno);
+        if (fd >= 0) close(fd);
+        throw std::runtime_error("Cannot listen on " + config_.socket_path + ": " + reason);
+    }
+
+    set_nonblocking(fd);
+    listen_fd_ = fd;
+    return true;
+}
+
+void LeaseServer::refresh_busy() {
+    last_refresh_ = Clock::now();
+
+    platform::SocketSnapshot snapshot;
+    try {
+        snapshot = platform::SocketSnapshot::capture();
+    } catch (const std::exception&) {
+        return;  // Keep the previous table; bind() still guards every grant
+    }
+
+    std::fill(busy_.begin(), busy_.end(), 0);
+    for (uint32_t port = config_.first_port; port <= config_.last_port; port++) {
+        if (snapshot.is_listening(static_cast<uint16_t>(port))) {
+            mark_busy(static_cast<uint16_t>(port));
+        }
+    }
+}
+
+void LeaseServer::run() {
+    // SIGINT/SIGTERM end the loop so the destructor removes the socket file
+    struct sigaction stop{};
+    stop.sa_handler = request_stop;
+    sigaction(SIGINT, &stop, nullptr);
+    sigaction(SIGTERM, &stop, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+    refresh_busy();
+
+    auto idle_since = Clock::now();
+    std::vector<pollfd> fds;
+
+    while (!g_stop) {
+        auto now = Clock::now();
+        if (now >= next_expiry_check_) {
+            expire_leases(now);
+            next_expiry_check_ = now + std::chrono::milliseconds(100);
+        }
+        if (now - last_refresh_ >= config_.refresh) refresh_busy();
+
+        if (!clients_.empty() || !leases_.empty()) {
+            idle_since = now;
+        } else if (config_.idle_exit.count() > 0 && now - idle_since >= config_.idle_exit) {
+            return;
+        }
+
+        fds.clear();
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (const auto& [fd, client] : clients_) fds.push_back({fd, POLLIN, 0});
+
+        if (poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR) {
+            throw std::runtime_error(std::string("poll: ") + std::strerror(errno));
+        }
+
+        for (size_t i = 1; i < fds.size(); i++) {
+            if (fds[i].revents == 0) continue;
+
+            auto it = clients_.find(fds[i].fd);
+            if (it != clients_.end() && !handle_input(fds[i].fd, it->second)) {
+                drop_client(fds[i].fd);
+            }
+        }
+        if (fds[0].revents & POLLIN) accept_clients();
+    }
+}
+
+void LeaseServer::accept_clients() {
+    while (true) {
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) return;
+
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        set_nonblocking(fd);
+        Client client;
+        client.id = ++next_client_id_;
+        clients_.emplace(fd, std::move(client));
+    }
+}
+
+// Read and answer complete request lines. Returns false once the client is gone.
+bool LeaseServer::handle_input(int fd, Client& client) {
+    char buf[4096];
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    if (n == 0) return false;
+
+    client.input.append(buf, static_cast<size_t>(n));
+    if (client.input.size() > 65536) return false;
+
+    size_t start = 0;
+    size_t newline;
+    while ((newline = client.input.find('\n', start)) != std::string::npos) {
+        std::string line = client.input.substr(start, newline - start);
+        start = newline + 1;
+
+        std::string reply = handle_request(fd, client, line);
+        if (!reply.empty() && !send_line(fd, reply)) return false;
+    }
+    client.input.erase(0, start);
+    return true;
+}
+
+// Answer one request; an empty reply means it was already sent
+std::string LeaseServer::handle_request(int fd, Client& client, const std::string& line) {
+    std::istringstream in(line);
+    std::string verb;
+    in >> verb;
+
+    if (verb == "LEASE") {
+        size_t count = 0;
+        long ttl = -1;
+        if (!(in >> count >> ttl) || count == 0 || count > 1024 || ttl < 0) {
+            return "ERR usage: LEASE <count 1-1024> <ttl seconds>\n";
+        }
+
+        auto ports = grant(fd, client, count, std::chrono::seconds(ttl));
+        if (ports.empty()) return "ERR no free ports left in range\n";
+
+        std::string reply = "OK";
+        for (uint16_t port : ports) reply += " " + std::to_string(port);
+        return reply + "\n";
+    }
+
+    if (verb == "BIND") {
+        auto ports = grant(fd, client, 1, std::chrono::seconds(0));
+        if (ports.empty()) return "ERR no free ports left in range\n";
+
+        int socket_fd = bound_socket(ports.front());
+        if (socket_fd < 0) {
+            release(ports.front());
+            return std::string("ERR bind: ") + std::strerror(errno) + "\n";
+        }
+        send_line(fd, "OK " + std::to_string(ports.front()) + "\n", socket_fd);
+        close(socket_fd);
+        return "";
+    }
+
+    if (verb == "RELEASE") {
+        unsigned port = 0;
+        if (!(in >> port) || port > 65535) return "ERR usage: RELEASE <port>\n";
+
+        auto lease = leases_.find(static_cast<uint16_t>(port));
+        if (lease == leases_.end() || lease->second.leased_by != client.id) {
+            return "ERR not leased by this client\n";
+        }
+        release(static_cast<uint16_t>(port));
+        return "OK\n";
+    }
+
+    if (verb == "STATUS") {
+        size_t busy = 0;
+        for (uint32_t port = config_.first_port; port <= config_.last_port; port++) {
+            busy += (busy_[port >> 6] >> (port & 63)) & 1;
+        }
+        return "OK leased=" + std::to_string(leases_.size()) + " busy=" + std::to_string(busy) +
+               " range=" + std::to_string(config_.first_port) + "-" +
+               std::to_string(config_.last_port) + " granted=" + std::to_string(granted_) + "\n";
+    }
+
+    return "ERR unknown request\n";
+}
+
+// Reserve `count` ports (all or none), starting after the last one handed out
+std::vector<uint16_t> LeaseServer::grant(int fd, Client& client, size_t count,
+                                         std::chrono::seconds ttl) {
+    std::vector<uint16_t> ports;
+    uint32_t span = static_cast<uint32_t>(config_.last_port) - config_.first_port + 1;
+    auto expires = ttl.count() > 0 ? Clock::now() + ttl : Clock::time_point::max();
+
+    for (uint32_t tried = 0; tried < span && ports.size() < count; tried++) {
+        uint16_t port = static_cast<uint16_t>(config_.first_port + cursor_);
+        cursor_ = (cursor_ + 1) % span;
+
+        if (!is_free(port)) continue;
+        if (!bind_confirms_free(port)) {
+            mark_busy(port);  // Bound since the last table read
+            continue;
+        }
+
+        Lease lease;
+        lease.leased_by = client.id;
+        lease.expires = expires;
+        if (ttl.count() == 0) {
+            lease.client = fd;
+            client.ports.push_back(port);
+        }
+        leases_.emplace(port, lease);
+        ports.push_back(port);
+    }
+
+    if (ports.size() < count) {
+        for (uint16_t port : ports) release(port);
+        return {};
+    }
+
+    granted_ += ports.size();
+    return ports;
+}
+
+void LeaseServer::release(uint16_t port) {
+    auto it = leases_.find(port);
+    if (it == leases_.end()) return;
+
+    auto owner = clients_.find(it->second.client);
+    if (owner != clients_.end()) {
+        auto& held = owner->second.ports;
+        held.erase(std::remove(held.begin(), held.end(), port), held.end());
+    }
+    leases_.erase(it);
+}
+
+void LeaseServer::drop_client(int fd) {
+    auto it = clients_.find(fd);
+    if (it == clients_.end()) return;
+
+    for (uint16_t port : it->second.ports) leases_.erase(port);
+    clients_.erase(it);
+    close(fd);
+}
+
+void LeaseServer::expire_leases(Clock::time_point now) {
+    for (auto it = leases_.begin(); it != leases_.end();) {
+        if (it->second.client < 0 && it->second.expires <= now) {
+            it = leases_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// -- Client --
+
+LeaseClient::~LeaseClient() {
+    if (fd_ >= 0) close(fd_);
+}
+
+bool LeaseClient::connect(const std::string& socket_path,
+                          const std::vector<std::string>& spawn_argv) {
+    sockaddr_un addr = unix_address(socket_path);
+    auto try_connect = [&]() {
+        int fd = open_socket(AF_UNIX, SOCK_STREAM);
+        if (fd < 0) return false;
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            return false;
+        }
+        fd_ = fd;
+        return true;
+    };
+
+    if (try_connect()) return true;
+    if (spawn_argv.empty()) return false;
+
+    // Double fork so the daemon is reparented and never left a zombie
+    pid_t child = fork();
+    if (child < 0) return false;
+    if (child == 0) {
+        setsid();
+        if (fork() != 0) _exit(0);
+
+        int null_fd = open("/dev/null", O_RDWR);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDIN_FILENO);
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+        }
+
+        std::vector<char*> argv;
+        for (const auto& arg : spawn_argv) argv.push_back(const_cast<char*>(arg.c_str()));
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    waitpid(child, nullptr, 0);
+
+    // Wait for the daemon (ours, or one a concurrent client started) to listen
+    auto delay = std::chrono::milliseconds(1);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (try_connect()) return true;
+        std::this_thread::sleep_for(delay);
+        delay = std::min(delay * 2, std::chrono::milliseconds(50));
+    }
+    return false;
+}
+
+std::string LeaseClient::request(const std::string& line, int* received_fd) {
+    if (!send_line(fd_, line + "\n")) {
+        throw std::runtime_error("Lease daemon connection lost");
+    }
+
+    std::string reply;
+    while (reply.empty() || reply.back() != '\n') {
+        char buf[512];
+        iovec iov{buf, sizeof(buf)};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t n = recvmsg(fd_, &msg, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error("Lease daemon connection lost");
+        reply.append(buf, static_cast<size_t>(n));
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                int fd;
+                std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+                if (received_fd) {
+                    *received_fd = fd;
+                } else {
+                    close(fd);
+                }
+            }
+        }
+    }
+    reply.pop_back();
+
+    if (reply.compare(0, 4, "ERR ") == 0) throw std::runtime_error(reply.substr(4));
+    if (reply.compare(0, 2, "OK") != 0) throw std::runtime_error("Unexpected reply: " + reply);
+    return reply.size() > 3 ? reply.substr(3) : "";
+}
+
+std::vector<uint16_t> LeaseClient::lease(size_t count, std::chrono::seconds ttl) {
+    std::istringstream in(request("LEASE " + std::to_string(count) + " " +
+                                  std::to_string(ttl.count())));
+    std::vector<uint16_t> ports;
+    unsigned port;
+    while (in >> port) ports.push_back(static_cast<uint16_t>(port));
+    return ports;
+}
+
+int LeaseClient::lease_bound_socket(uint16_t& port) {
+    int fd = -1;
+    port = static_cast<uint16_t>(std::stoul(request("BIND", &fd)));
+    if (fd < 0) throw std::runtime_error("Lease daemon sent no socket");
+    return fd;
+}
+
+std::string LeaseClient::status() {
+    return request("STATUS");
+}
+
+} // namespace zohd
+
+#endif // PLATFORM_WINDOWS
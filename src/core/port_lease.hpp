@@ -0,0 +1,129 @@
+#pragma once
+
+#ifndef PLATFORM_WINDOWS
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace zohd {
+
+// Port reservation daemon for parallel jobs. Clients talk to it over a
+// Unix stream socket, one request line per call:
+//
+//   LEASE <count> <ttl>  ->  OK <port>...   (ttl 0: held until the client disconnects)
+//   BIND                 ->  OK <port>      plus a bound TCP socket via SCM_RIGHTS
+//   RELEASE <port>       ->  OK             (only ports this connection leased)
+//   STATUS               ->  OK leased=<n> busy=<n> range=<first>-<last> granted=<n>
+//
+// Errors are answered with "ERR <reason>". Every port handed out is
+// confirmed free with a real bind() first, and stays reserved until it is
+// released, its TTL runs out or the client that leased it disconnects.
+struct LeaseServerConfig {
+    std::string socket_path;
+    uint16_t first_port = 10000;
+    uint16_t last_port = 32767;                          // Below the usual ephemeral range
+    std::chrono::seconds refresh{30};                    // Re-read the socket table this often
+    std::chrono::seconds idle_exit{0};                   // Exit when idle this long (0 = never)
+};
+
+class LeaseServer {
+public:
+    explicit LeaseServer(LeaseServerConfig config);
+    ~LeaseServer();
+
+    LeaseServer(const LeaseServer&) = delete;
+    LeaseServer& operator=(const LeaseServer&) = delete;
+
+    // Take the daemon lock and bind the Unix socket. Returns false if another
+    // daemon already serves the path (a stale socket file is replaced).
+    // Throws std::runtime_error if the socket cannot be created.
+    bool listen();
+
+    // Serve until idle_exit (if set) expires or SIGINT/SIGTERM arrives
+    void run();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Lease {
+        int client = -1;            // Owning connection (ttl 0), -1 for TTL leases
+        uint64_t leased_by = 0;     // Client::id of the connection that asked for it
+        Clock::time_point expires;  // Clock::time_point::max() for ttl 0
+    };
+
+    struct Client {
+        uint64_t id = 0;            // Unique per connection, unlike its fd
+        std::string input;
+        std::vector<uint16_t> ports;
+    };
+
+    void refresh_busy();
+    void accept_clients();
+    bool handle_input(int fd, Client& client);
+    std::string handle_request(int fd, Client& client, const std::string& line);
+    std::vector<uint16_t> grant(int fd, Client& client, size_t count, std::chrono::seconds ttl);
+    void release(uint16_t port);
+    void drop_client(int fd);
+    void expire_leases(Clock::time_point now);
+
+    bool is_free(uint16_t port) const {
+        return !((busy_[port >> 6] >> (port & 63)) & 1) && leases_.count(port) == 0;
+    }
+    void mark_busy(uint16_t port) {
+        busy_[port >> 6] |= uint64_t{1} << (port & 63);
+    }
+
+    LeaseServerConfig config_;
+    int lock_fd_ = -1;
+    int listen_fd_ = -1;
+    std::vector<uint64_t> busy_;                   // In use per the last socket table read
+    std::unordered_map<uint16_t, Lease> leases_;
+    std::unordered_map<int, Client> clients_;
+    uint32_t cursor_;                              // Next port to try, rotates over the range
+    uint64_t granted_ = 0;
+    uint64_t next_client_id_ = 0;
+    Clock::time_point last_refresh_;
+    Clock::time_point next_expiry_check_;
+};
+
+// Client side of the lease protocol
+class LeaseClient {
+public:
+    LeaseClient() = default;
+    ~LeaseClient();
+
+    LeaseClient(const LeaseClient&) = delete;
+    LeaseClient& operator=(const LeaseClient&) = delete;
+
+    // Connect to the daemon at `socket_path`. If none is running and
+    // `spawn_argv` is non-empty, start it (detached) with that command line
+    // and retry for up to two seconds.
+    bool connect(const std::string& socket_path, const std::vector<std::string>& spawn_argv);
+
+    // Reserve `count` ports. ttl 0 ties them to this connection.
+    // Throws std::runtime_error with the daemon's reason on failure.
+    std::vector<uint16_t> lease(size_t count, std::chrono::seconds ttl);
+
+    // Reserve one port and receive a TCP socket already bound to it
+    int lease_bound_socket(uint16_t& port);
+
+    std::string status();
+
+    // The connection; leases with ttl 0 last as long as it stays open
+    int fd() const { return fd_; }
+
+private:
+    std::string request(const std::string& line, int* received_fd = nullptr);
+
+    int fd_ = -1;
+};
+
+// $XDG_RUNTIME_DIR/zohd-lease.sock, or /tmp/zohd-lease-<uid>.sock
+std::string default_lease_socket_path();
+
+} // namespace zohd
+
+#endif // PLATFORM_WINDOWS
@@ -0,0 +1,171 @@
+#include "port_watcher.hpp"
+#include "../platform/socket_snapshot.hpp"
+
+#include <algorithm>
+
+namespace zohd {
+
+PortWatcher::~PortWatcher() {
+    for (const auto& [pid, handle] : handles_) platform::close_process_handle(handle);
+}
+
+std::vector<WatchEvent> PortWatcher::poll() {
+    std::vector<WatchEvent> events;
+    tick_++;
+
+    platform::SocketSnapshot snapshot = platform::SocketSnapshot::capture();
+
+    // Mark surviving sockets, collect new ones
+    std::vector<unsigned long> to_resolve;
+    std::vector<unsigned long> opened;
+    for (const auto& entry : snapshot.entries()) {
+        if (entry.inode == 0) continue;
+
+        auto it = sockets_.find(entry.inode);
+        if (it != sockets_.end()) {
+            it->second.seen_tick = tick_;
+            continue;
+        }
+
+        Tracked tracked;
+        tracked.socket = entry;
+        tracked.seen_tick = tick_;
+        sockets_.emplace(entry.inode, std::move(tracked));
+        opened.push_back(entry.inode);
+        to_resolve.push_back(entry.inode);
+    }
+
+    // Anything not seen this tick has closed
+    for (auto it = sockets_.begin(); it != sockets_.end();) {
+        if (it->second.seen_tick == tick_) {
+            ++it;
+            continue;
+        }
+
+        WatchEvent event;
+        event.type = WatchEvent::Type::CLOSED;
+        event.socket = it->second.socket;
+        event.previous_pid = it->second.pid;
+        event.process = it->second.process;
+        events.push_back(std::move(event));
+        it = sockets_.erase(it);
+    }
+
+    // Owners of the surviving sockets, and unresolved sockets due a retry
+    std::unordered_map<uint32_t, std::vector<unsigned long>> by_owner;
+    std::vector<unsigned long> retried;
+    for (const auto& [inode, tracked] : sockets_) {
+        if (tracked.pid != 0) {
+            by_owner[tracked.pid].push_back(inode);
+        } else if (tracked.retry_tick != 0 && tracked.retry_tick <= tick_) {
+            retried.push_back(inode);
+            to_resolve.push_back(inode);
+        }
+    }
+
+    // Release the handles of owners whose sockets all closed
+    for (auto it = handles_.begin(); it != handles_.end();) {
+        if (by_owner.count(it->first)) {
+            ++it;
+            continue;
+        }
+        platform::close_process_handle(it->second);
+        it = handles_.erase(it);
+    }
+
+    // Owners that exited, from one poll() over their pidfds; without one,
+    // probe with signal 0. Their sockets are re-resolved (inherited by a
+    // child, passed over a unix socket, ...).
+    std::vector<uint32_t> pids;
+    std::vector<int> handles;
+    for (const auto& [pid, inodes] : by_owner) {
+        auto handle = handles_.find(pid);
+        pids.push_back(pid);
+        handles.push_back(handle != handles_.end() ? handle->second : -1);
+    }
+    std::vector<bool> exited(pids.size(), false);
+    for (size_t i : platform::exited_process_handles(handles)) exited[i] = true;
+
+    std::vector<unsigned long> orphaned;
+    for (size_t i = 0; i < pids.size(); i++) {
+        if (handles[i] < 0) exited[i] = !platform::is_process_alive(pids[i]);
+        if (!exited[i]) continue;
+
+        const auto& inodes = by_owner[pids[i]];
+        orphaned.insert(orphaned.end(), inodes.begin(), inodes.end());
+        to_resolve.insert(to_resolve.end(), inodes.begin(), inodes.end());
+        platform::close_process_handle(handles[i]);
+        handles_.erase(pids[i]);
+    }
+
+    if (to_resolve.empty()) return events;
+
+    auto owners = platform::find_socket_owners(to_resolve);
+    std::unordered_map<uint32_t, std::string> names;
+    auto resolve = [&](Tracked& tracked, unsigned long inode) {
+        auto owner = owners.find(inode);
+        tracked.pid = owner != owners.end() ? owner->second : 0;
+        if (tracked.pid == 0) {
+            tracked.process.clear();
+            tracked.retry_interval = tracked.retry_interval == 0
+                ? 1 : std::min(tracked.retry_interval * 2, MAX_RETRY_INTERVAL);
+            tracked.retry_tick = tick_ + tracked.retry_interval;
+            return;
+        }
+
+        tracked.retry_tick = 0;
+        tracked.retry_interval = 0;
+        auto name = names.find(tracked.pid);
+        if (name == names.end()) {
+            auto info = platform::get_process_info(tracked.pid, platform::PROCESS_NAME);
+            name = names.emplace(tracked.pid, info.name).first;
+        }
+        tracked.process = name->second;
+        if (!handles_.count(tracked.pid)) {
+            handles_.emplace(tracked.pid, platform::open_process_handle(tracked.pid));
+        }
+    };
+
+    for (unsigned long inode : opened) {
+        Tracked& tracked = sockets_[inode];
+        resolve(tracked, inode);
+
+        WatchEvent event;
+        event.type = WatchEvent::Type::OPENED;
+        event.socket = tracked.socket;
+        event.pid = tracked.pid;
+        event.process = tracked.process;
+        events.push_back(std::move(event));
+    }
+
+    for (unsigned long inode : orphaned) {
+        Tracked& tracked = sockets_[inode];
+        WatchEvent event;
+        event.type = WatchEvent::Type::OWNER_CHANGED;
+        event.socket = tracked.socket;
+        event.previous_pid = tracked.pid;
+
+        resolve(tracked, inode);
+        event.pid = tracked.pid;
+        event.process = tracked.process;
+        events.push_back(std::move(event));
+    }
+
+    // A socket whose owner shows up late is reported like an owner change
+    for (unsigned long inode : retried) {
+        Tracked& tracked = sockets_[inode];
+        resolve(tracked, inode);
+        if (tracked.pid == 0) continue;
+
+        WatchEvent event;
+        event.type = WatchEvent::Type::OWNER_CHANGED;
+        event.socket = tracked.socket;
+        event.pid = tracked.pid;
+        event.process = tracked.process;
+        events.push_back(std::move(event));
+    }
+
+    return events;
+}
+
+} // namespace zohd
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../platform/platform_interface.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace zohd {
+
+// A change in the listening socket table between two polls
+struct WatchEvent {
+    enum class Type {
+        OPENED,         // New listening socket
+        CLOSED,         // Listening socket went away
+        OWNER_CHANGED   // Socket still listening, owning process changed
+    };
+
+    Type type;
+    platform::SocketEntry socket;
+    uint32_t pid = 0;           // Current owner (0 if unknown)
+    uint32_t previous_pid = 0;  // OWNER_CHANGED / CLOSED: former owner
+    std::string process;        // Name of `pid` (or of the former owner on CLOSE)
+};
+
+// Long-running incremental monitor. Keeps the previous socket table and
+// inode -> owner map in memory and only resolves owners for sockets that
+// are new, whose owner has exited, or that had no visible owner yet. Each
+// owner is held by a pidfd, so noticing exits (even of an owner whose PID
+// was since reused) takes one poll() per tick however many owners there are.
+class PortWatcher {
+public:
+    PortWatcher() = default;
+    ~PortWatcher();
+    PortWatcher(const PortWatcher&) = delete;
+    PortWatcher& operator=(const PortWatcher&) = delete;
+
+    // Capture the socket table and return what changed since the last call.
+    // The first call reports every current listener as OPENED.
+    std::vector<WatchEvent> poll();
+
+private:
+    // Unresolved sockets are retried after 1, 2, 4, ... polls, up to this
+    // many, so sockets no process will ever show (another user's, without
+    // root) don't cost a /proc walk on every poll
+    static constexpr uint64_t MAX_RETRY_INTERVAL = 64;
+
+    struct Tracked {
+        platform::SocketEntry socket;
+        uint32_t pid = 0;
+        std::string process;
+        uint64_t seen_tick = 0;
+        uint64_t retry_tick = 0;      // pid == 0: poll to look again (0 = not scheduled)
+        uint64_t retry_interval = 0;
+    };
+
+    std::unordered_map<unsigned long, Tracked> sockets_;  // By inode
+    std::unordered_map<uint32_t, int> handles_;  // Owner PID -> process handle (-1 if none)
+    uint64_t tick_ = 0;
+};
+
+} // namespace zohd
@@ -0,0 +1,193 @@
+#include "profiler.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+#ifdef PLATFORM_WINDOWS
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace zohd {
+namespace profiler {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Event {
+    const char* name;
+    uint32_t thread;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    Counts counts;
+};
+
+const char* const COUNTER_NAMES[COUNTER_COUNT] = {
+    "files_opened", "dirs_scanned", "readlinks", "bytes_read", "netlink_recvs", "bytes_written"};
+
+Clock::time_point g_origin;
+std::mutex g_mutex;
+std::vector<Event> g_events;
+Counts g_retired{};   // Counters of threads that have exited
+std::atomic<uint32_t> g_next_thread{0};
+
+// Counters are per thread so the probes need no atomics; a thread's totals
+// are folded into g_retired when it exits
+struct ThreadState {
+    uint32_t id = g_next_thread.fetch_add(1);
+    Counts counts{};
+
+    ~ThreadState() {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        for (size_t i = 0; i < COUNTER_COUNT; i++) g_retired[i] += counts[i];
+    }
+};
+
+ThreadState& thread_state() {
+    thread_local ThreadState state;
+    return state;
+}
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - g_origin).count());
+}
+
+// Counters of every thread so far (call after worker threads have joined)
+Counts total_counts() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    Counts totals = g_retired;
+    const Counts& own = thread_state().counts;
+    for (size_t i = 0; i < COUNTER_COUNT; i++) totals[i] += own[i];
+    return totals;
+}
+
+} // namespace
+
+void detail::add(Counter counter, uint64_t amount) {
+    thread_state().counts[counter] += amount;
+}
+
+void enable() {
+    g_origin = Clock::now();
+    detail::enabled = true;
+}
+
+void Phase::begin(const char* name) {
+    name_ = name;
+    start_counts_ = thread_state().counts;
+    start_ns_ = now_ns();
+}
+
+void Phase::end() {
+    uint64_t end_ns = now_ns();
+    ThreadState& state = thread_state();
+
+    Event event{name_, state.id, start_ns_, end_ns - start_ns_, {}};
+    for (size_t i = 0; i < COUNTER_COUNT; i++) {
+        event.counts[i] = state.counts[i] - start_counts_[i];
+    }
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_events.push_back(event);
+}
+
+void print_summary(std::ostream& out) {
+    if (!detail::enabled) return;
+
+    // Aggregate by phase name, in order of first completion
+    struct Row {
+        std::string name;
+        uint64_t calls = 0;
+        uint64_t total_ns = 0;
+        Counts counts{};
+    };
+    std::vector<Row> rows;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        for (const auto& event : g_events) {
+            Row* row = nullptr;
+            for (auto& existing : rows) {
+                if (existing.name == event.name) row = &existing;
+            }
+            if (!row) {
+                rows.push_back(Row{event.name});
+                row = &rows.back();
+            }
+            row->calls++;
+            row->total_ns += event.duration_ns;
+            for (size_t i = 0; i < COUNTER_COUNT; i++) row->counts[i] += event.counts[i];
+        }
+    }
+
+    auto print_counts = [&out](const Counts& counts) {
+        out << std::setw(8) << counts[FILES_OPENED]
+            << std::setw(8) << counts[DIRS_SCANNED]
+            << std::setw(11) << counts[READLINKS]
+            << std::setw(9) << counts[NETLINK_RECVS]
+            << std::setw(12) << counts[BYTES_READ]
+            << std::setw(10) << counts[BYTES_WRITTEN] << "\n";
+    };
+
+    out << "\nProfile (" << std::fixed << std::setprecision(2) << now_ns() / 1e6
+        << " ms wall, phases inclusive):\n";
+    out << std::left << std::setw(24) << "PHASE" << std::right
+        << std::setw(8) << "CALLS"
+        << std::setw(11) << "TOTAL ms"
+        << std::setw(8) << "OPENS"
+        << std::setw(8) << "DIRS"
+        << std::setw(11) << "READLINKS"
+        << std::setw(9) << "NETLINK"
+        << std::setw(12) << "READ B"
+        << std::setw(10) << "WRITE B" << "\n";
+    out << std::string(101, '-') << "\n";
+
+    for (const auto& row : rows) {
+        out << std::left << std::setw(24) << row.name << std::right
+            << std::setw(8) << row.calls
+            << std::setw(11) << row.total_ns / 1e6;
+        print_counts(row.counts);
+    }
+
+    out << std::left << std::setw(43) << "all threads" << std::right;
+    print_counts(total_counts());
+}
+
+bool write_trace(const std::string& path) {
+    if (!detail::enabled) return false;
+
+    std::ofstream file(path);
+    if (!file) return false;
+
+    long pid = static_cast<long>(getpid());
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+         << ",\"tid\":0,\"args\":{\"name\":\"zohd\"}}";
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    char times[64];
+    for (const auto& event : g_events) {
+        // Trace timestamps are microseconds
+        std::snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f",
+                      event.start_ns / 1e3, event.duration_ns / 1e3);
+        file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"zohd\",\"ph\":\"X\","
+             << times << ",\"pid\":" << pid << ",\"tid\":" << event.thread << ",\"args\":{";
+        for (size_t i = 0; i < COUNTER_COUNT; i++) {
+            file << (i ? "," : "") << "\"" << COUNTER_NAMES[i] << "\":" << event.counts[i];
+        }
+        file << "}}";
+    }
+    file << "\n]}\n";
+
+    return static_cast<bool>(file);
+}
+
+} // namespace profiler
+} // namespace zohd
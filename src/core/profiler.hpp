@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace zohd {
+namespace profiler {
+
+// I/O work counted by the instrumented hot paths
+enum Counter : size_t {
+    FILES_OPENED,
+    DIRS_SCANNED,
+    READLINKS,
+    BYTES_READ,
+    NETLINK_RECVS,
+    BYTES_WRITTEN,
+    COUNTER_COUNT
+};
+
+using Counts = std::array<uint64_t, COUNTER_COUNT>;
+
+namespace detail {
+inline bool enabled = false;
+void add(Counter counter, uint64_t amount);
+}
+
+// Start recording phases and counters (for --profile / --trace).
+// Off by default; every probe is then a single predictable branch.
+void enable();
+
+inline bool enabled() {
+    return detail::enabled;
+}
+
+inline void count(Counter counter, uint64_t amount = 1) {
+    if (detail::enabled) detail::add(counter, amount);
+}
+
+// Times the enclosing scope as a named phase. Counter deltas are those of
+// the calling thread; phases nest and are reported inclusive.
+class Phase {
+public:
+    explicit Phase(const char* name) {
+        if (detail::enabled) begin(name);
+    }
+    ~Phase() {
+        if (name_) end();
+    }
+
+    Phase(const Phase&) = delete;
+    Phase& operator=(const Phase&) = delete;
+
+private:
+    void begin(const char* name);
+    void end();
+
+    const char* name_ = nullptr;
+    uint64_t start_ns_ = 0;
+    Counts start_counts_{};
+};
+
+// Per-phase totals (calls, wall time, counters) and process-wide counters
+void print_summary(std::ostream& out);
+
+// Chrome trace-event JSON (chrome://tracing, Perfetto). Returns false if
+// the file cannot be written.
+bool write_trace(const std::string& path);
+
+} // namespace profiler
+} // namespace zohd
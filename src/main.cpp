@@ -1,61 +1,451 @@
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
 #include <iostream>
+#include <map>
 #include <string>
+#include <thread>
+#include <vector>
 #include "CLI11.hpp"
 #include "core/port_scanner.hpp"
 #include "core/process_manager.hpp"
+#include "core/port_watcher.hpp"
+#include "core/connection_stats.hpp"
+#include "core/ephemeral_ports.hpp"
+#include "core/accept_queue.hpp"
+#include "core/profiler.hpp"
 #include "cli/output_formatter.hpp"
+#include "platform/platform_interface.hpp"
+#include "platform/socket_snapshot.hpp"
+#include "platform/socket_table.hpp"
+
+#ifndef PLATFORM_WINDOWS
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "core/port_lease.hpp"
+#endif
 
 using namespace zohd;
 
+// Resolve only the process fields the current command prints
+static void use_process_fields(uint32_t fields) {
+    auto options = platform::get_options();
+    options.process_fields = fields;
+    platform::set_options(options);
+}
+
+// Parse "8080" or "8000-8090" and append its ports to `ports`.
+// Returns an error message, empty on success.
+static std::string parse_port_spec(const std::string& spec, std::vector<uint16_t>& ports) {
+    size_t dash = spec.find('-');
+    std::string first_text = spec.substr(0, dash);
+    std::string last_text = dash == std::string::npos ? first_text : spec.substr(dash + 1);
+
+    auto to_port = [](const std::string& text, long& value) {
+        if (text.empty() || text.size() > 5 ||
+            text.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        value = std::stol(text);
+        return value >= 1 && value <= 65535;
+    };
+
+    long first = 0;
+    long last = 0;
+    if (!to_port(first_text, first) || !to_port(last_text, last)) {
+        return "Invalid port or range '" + spec + "' (expected 1-65535 or FIRST-LAST)";
+    }
+    if (first > last) {
+        return "Range '" + spec + "' is reversed";
+    }
+
+    for (long port = first; port <= last; port++) {
+        ports.push_back(static_cast<uint16_t>(port));
+    }
+    return "";
+}
+
+// Expand port arguments into a list, in order, without duplicates
+static std::vector<uint16_t> expand_ports(const std::vector<std::string>& specs) {
+    std::vector<uint16_t> expanded;
+    for (const auto& spec : specs) parse_port_spec(spec, expanded);
+
+    std::bitset<65536> seen;
+    std::vector<uint16_t> ports;
+    for (uint16_t port : expanded) {
+        if (seen.test(port)) continue;
+        seen.set(port);
+        ports.push_back(port);
+    }
+    return ports;
+}
+
+// Free ports from PortScanner, minus any the kernel may pick for an
+// outbound connection, so a server is never handed one a client is about to
+// take. Asks the scanner for more candidates until `count` remain.
+static std::vector<uint16_t> suggest_ports(size_t count) {
+    PortScanner scanner;
+    auto range = platform::get_ephemeral_range();
+
+    std::vector<uint16_t> result;
+    for (size_t want = count; ; want *= 2) {
+        auto candidates = scanner.suggest_free_ports(want);
+        result.clear();
+        for (uint16_t port : candidates) {
+            if (range.contains(port)) continue;
+            result.push_back(port);
+            if (result.size() == count) return result;
+        }
+        // The scanner ran out of candidates
+        if (candidates.size() < want || want >= 65535) return result;
+    }
+}
+
+// SIGTERM the owners in `targets` (SIGKILL at the timeout with `escalate`),
+// then confirm each port has left the socket table and print how long it
+// took. `owners` is the table the targets were chosen from. Returns false
+// if any owner could not be signalled or any port is still held at the
+// deadline.
+static bool kill_and_wait(const std::map<uint32_t, std::vector<const PortInfo*>>& targets,
+                          const platform::SocketTable& owners, double timeout, bool escalate) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+
+    std::vector<ProcessInfo> processes;
+    for (const auto& [pid, held] : targets) processes.push_back(*held.front()->process);
+    auto stopped = platform::stop_processes(processes, timeout, escalate);
+
+    struct Pending {
+        const PortInfo* info;
+        const platform::StopResult* result;
+        uint32_t protocols = 0;  // protocol_bit() mask of the owner's rows
+        double released = -1;
+    };
+    std::vector<Pending> ports;
+    uint32_t watched = 0;
+    for (size_t i = 0; i < processes.size(); i++) {
+        for (const auto* info : targets.at(processes[i].pid)) {
+            // Only the protocols the owner held the port with are waited
+            // for, so an unrelated UDP socket on a killed TCP port does not
+            // hold things up. The table covers this network namespace only.
+            Pending port{info, &stopped[i]};
+            for (size_t row = 0; row < owners.size(); row++) {
+                const platform::ProcessRecord* owner = owners.process(row);
+                if (owners.port(row) == info->port && owner && owner->pid == processes[i].pid) {
+                    port.protocols |= platform::protocol_bit(owners.protocol(row));
+                }
+            }
+            watched |= port.protocols;
+            ports.push_back(port);
+        }
+    }
+
+    // Sockets normally close with their owner, but a child that inherited
+    // the listener keeps the port held, so check the table itself. The
+    // kernel closes a process's files before its pidfd turns readable, so a
+    // port already free on the first pass was released at its owner's exit.
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                std::chrono::duration<double>(timeout + (escalate ? 1.0 : 0.0)));
+    auto delay = std::chrono::milliseconds(1);
+    for (bool first_pass = true;; first_pass = false) {
+        auto snapshot = platform::SocketSnapshot::capture(watched);
+        double now_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        size_t waiting = 0;
+        for (auto& port : ports) {
+            if (port.released >= 0 || (!port.result->signalled && !port.result->exited)) continue;
+
+            bool held = false;
+            for (auto protocol : {platform::Protocol::TCP, platform::Protocol::UDP,
+                                  platform::Protocol::UDPLITE}) {
+                if (port.protocols & platform::protocol_bit(protocol)) {
+                    held = held || snapshot.is_bound(protocol, port.info->port);
+                }
+            }
+            if (held) {
+                waiting++;
+            } else {
+                port.released = first_pass && port.result->exited ? port.result->seconds
+                                                                  : now_seconds;
+            }
+        }
+        if (waiting == 0 || Clock::now() >= deadline) break;
+
+        std::this_thread::sleep_for(delay);
+        delay = std::min(delay * 2, std::chrono::milliseconds(50));
+    }
+
+    bool all_released = true;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cerr << std::fixed << std::setprecision(3);
+    for (const auto& port : ports) {
+        const auto& result = *port.result;
+        std::string owner = port.info->process->name + ", PID " + std::to_string(result.pid);
+
+        if (!result.signalled && !result.exited) {
+            std::cerr << "Failed to kill " << owner << " (port " << port.info->port
+                      << "): permission denied?\n";
+            all_released = false;
+        } else if (port.released >= 0) {
+            std::cout << "Port " << port.info->port << " released in " << port.released << "s ("
+                      << owner << (result.escalated ? ", SIGKILL" : "") << ")\n";
+        } else {
+            std::cerr << "Port " << port.info->port << " still in use after " << timeout << "s ("
+                      << owner << (result.exited ? " exited" : " did not exit") << ")\n";
+            all_released = false;
+        }
+    }
+    return all_released;
+}
+
+// Block until every port is listening (or, with !listening, free) or
+// `timeout` seconds pass (0 = no limit). With sock_diag, each round asks
+// the kernel only about the ports still pending, one port-filtered query
+// each; otherwise (procfs, --all-netns) a round reads one snapshot. Rounds
+// back off from 1ms to 8ms. Prints each port as it settles and returns
+// false on timeout.
+static bool wait_for_ports(const std::vector<uint16_t>& ports, bool listening, double timeout) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                std::chrono::duration<double>(timeout));
+    uint32_t protocols = platform::get_options().protocols;
+
+    // Past a handful of ports, one full snapshot beats a query per port
+    const size_t TARGETED_LIMIT = 8;
+
+    std::vector<uint16_t> pending = ports;
+    auto delay = std::chrono::microseconds(1000);
+    std::cout << std::fixed << std::setprecision(3);
+
+    while (true) {
+        std::vector<bool> bound(pending.size());
+        if (pending.size() <= TARGETED_LIMIT && platform::port_queries_filtered()) {
+            for (size_t i = 0; i < pending.size(); i++) {
+                bound[i] = !platform::get_sockets(protocols, pending[i]).empty();
+            }
+        } else {
+            auto snapshot = platform::SocketSnapshot::capture(protocols);
+            for (size_t i = 0; i < pending.size(); i++) bound[i] = snapshot.is_listening(pending[i]);
+        }
+
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::vector<uint16_t> still_pending;
+        for (size_t i = 0; i < pending.size(); i++) {
+            if (bound[i] == listening) {
+                std::cout << "Port " << pending[i] << (listening ? " is listening" : " is free")
+                          << " after " << seconds << "s\n" << std::flush;
+            } else {
+                still_pending.push_back(pending[i]);
+            }
+        }
+        pending.swap(still_pending);
+        if (pending.empty()) return true;
+
+        if (timeout > 0 && Clock::now() >= deadline) break;
+        std::this_thread::sleep_for(delay);
+        delay = std::min(delay * 2, std::chrono::microseconds(8000));
+    }
+
+    std::cerr << "Timed out after " << timeout << "s; still "
+              << (listening ? "not listening:" : "in use:");
+    for (uint16_t port : pending) std::cerr << " " << port;
+    std::cerr << "\n";
+    return false;
+}
+
 int main(int argc, char** argv) {
     CLI::App app{"zohd - Port conflict resolver v1.0.0"};
     app.require_subcommand(1);
+    app.fallthrough();
+
+    // Global options (apply to every subcommand)
+    std::map<std::string, platform::SocketBackend> backends{
+        {"auto", platform::SocketBackend::AUTO},
+        {"netlink", platform::SocketBackend::NETLINK},
+        {"procfs", platform::SocketBackend::PROCFS}};
+    platform::PlatformOptions platform_options;
+    app.add_option("--backend", platform_options.backend,
+                   "Socket table source: auto, netlink or procfs")
+       ->transform(CLI::CheckedTransformer(backends, CLI::ignore_case));
+    app.add_option("-j,--jobs", platform_options.jobs,
+                   "Threads for the /proc fd scan (0 = one per core)")
+       ->check(CLI::Range(0, 1024));
+    app.add_flag("--numeric-users", platform_options.numeric_users,
+                 "Show numeric uids instead of user names (skips NSS lookups)");
+    app.add_flag("--all-netns", platform_options.all_netns,
+                 "Include sockets from every network namespace (containers)");
+    bool no_cache = false;
+    app.add_flag("--no-cache", no_cache,
+                 "Re-read every process instead of using the PID metadata cache");
+    app.add_flag("--io-uring", platform_options.io_uring,
+                 "Read owners' /proc files in batches through io_uring (Linux 5.6+)");
+    app.add_option("--proc-root", platform_options.proc_root,
+                   "procfs to read instead of /proc (test fixtures)")
+       ->check(CLI::ExistingDirectory)
+       ->group("");
+    std::map<std::string, uint32_t> protocols{
+        {"tcp", platform::protocol_bit(platform::Protocol::TCP)},
+        {"udp", platform::protocol_bit(platform::Protocol::UDP)},
+        {"udplite", platform::protocol_bit(platform::Protocol::UDPLITE)},
+        {"unix", platform::protocol_bit(platform::Protocol::UNIX)},
+        {"all", platform::ALL_PROTOCOLS}};
+    std::vector<uint32_t> selected_protocols;
+    app.add_option("--proto", selected_protocols,
+                   "Protocols to consider: tcp, udp, udplite, unix, all (default: tcp,udp,udplite)")
+       ->delimiter(',')
+       ->transform(CLI::CheckedTransformer(protocols, CLI::ignore_case));
+
+    const CLI::Validator port_spec(
+        [](std::string& spec) {
+            std::vector<uint16_t> scratch;
+            return parse_port_spec(spec, scratch);
+        },
+        "PORT|FIRST-LAST");
+
+    std::map<std::string, OutputFormat> formats{
+        {"text", OutputFormat::TEXT},
+        {"json", OutputFormat::JSON},
+        {"jsonl", OutputFormat::JSONL},
+        {"csv", OutputFormat::CSV},
+        {"bin", OutputFormat::BIN}};
+    OutputFormat format = OutputFormat::TEXT;
+    app.add_option("--format", format,
+                   "Output of scan, list, check and info: text, json, jsonl, csv or bin")
+       ->transform(CLI::CheckedTransformer(formats, CLI::ignore_case));
+
+    bool profile = false;
+    std::string trace_path;
+    app.add_flag("--profile", profile,
+                 "Print per-phase wall time and I/O counts to stderr when done");
+    app.add_option("--trace", trace_path,
+                   "Write a Chrome trace-event file of the run's phases");
+
+    app.parse_complete_callback([&platform_options, &selected_protocols, &no_cache, &profile,
+                                 &trace_path]() {
+        if (profile || !trace_path.empty()) profiler::enable();
+        platform_options.pid_cache = !no_cache;
+        if (!selected_protocols.empty()) {
+            platform_options.protocols = 0;
+            for (uint32_t bits : selected_protocols) platform_options.protocols |= bits;
+        }
+        platform::set_options(platform_options);
+    });
 
     // SCAN command
     auto* scan_cmd = app.add_subcommand("scan", "Scan common development ports");
-    scan_cmd->callback([]() {
+    scan_cmd->callback([&format]() {
+        use_process_fields(platform::PROCESS_NAME | platform::PROCESS_START_TIME);
         PortScanner scanner;
-        auto results = scanner.scan_dev_ports();
-        OutputFormatter::print_scan_results(results);
+        std::vector<PortInfo> results;
+        {
+            profiler::Phase phase("scan_ports");
+            results = scanner.scan_dev_ports();
+        }
+        profiler::Phase phase("output");
+        if (format == OutputFormat::TEXT) {
+            OutputFormatter::print_scan_results(results);
+        } else {
+            OutputFormatter::write_ports(results, format);
+        }
     });
 
+    // Process exit status: `check` returns 1 if any port is in use,
+    // `kill` returns 1 if a process could not be killed
+    int exit_code = 0;
+
     // CHECK command
-    auto* check_cmd = app.add_subcommand("check", "Check if specific port is in use");
-    int check_port = 0;
-    check_cmd->add_option("port", check_port, "Port number to check")
+    auto* check_cmd = app.add_subcommand("check", "Check if ports are in use");
+    std::vector<std::string> check_specs;
+    check_cmd->add_option("ports", check_specs, "Ports or ranges (e.g. 3000 8000-8090)")
              ->required()
-             ->check(CLI::Range(1, 65535));
-    check_cmd->callback([&check_port]() {
-        PortScanner scanner;
-        auto info = scanner.check_port(static_cast<uint16_t>(check_port));
-        OutputFormatter::print_port_info(info);
+             ->check(port_spec);
+    check_cmd->callback([&check_specs, &format, &exit_code]() {
+        auto ports = expand_ports(check_specs);
+        if (ports.size() > 1 && format == OutputFormat::TEXT) {
+            use_process_fields(platform::PROCESS_NAME);
+        }
+
+        auto results = platform::check_ports(ports);
+        profiler::Phase phase("output");
+        if (format != OutputFormat::TEXT) {
+            OutputFormatter::write_ports(results, format);
+        } else if (results.size() == 1) {
+            OutputFormatter::print_port_info(results.front());
+        } else {
+            OutputFormatter::print_port_summary(results);
+        }
+
+        for (const auto& info : results) {
+            if (info.is_in_use()) exit_code = 1;
+        }
     });
 
     // KILL command
-    auto* kill_cmd = app.add_subcommand("kill", "Kill process using port");
-    int kill_port = 0;
+    auto* kill_cmd = app.add_subcommand("kill", "Kill processes using ports");
+    std::vector<std::string> kill_specs;
     bool force = false;
-    kill_cmd->add_option("port", kill_port, "Port number")
+    kill_cmd->add_option("ports", kill_specs, "Ports or ranges")
             ->required()
-            ->check(CLI::Range(1, 65535));
+            ->check(port_spec);
     kill_cmd->add_flag("-f,--force", force, "Force kill without confirmation");
-    kill_cmd->callback([&kill_port, &force]() {
-        PortScanner scanner;
-        auto info = scanner.check_port(static_cast<uint16_t>(kill_port));
+    bool kill_wait = false;
+    double kill_timeout = 10.0;
+    bool kill_escalate = false;
+    auto* wait_flag = kill_cmd->add_flag("-w,--wait", kill_wait,
+                                         "Wait until every port is released");
+    kill_cmd->add_option("-t,--timeout", kill_timeout, "Seconds to wait (default 10)")
+            ->check(CLI::Range(0.0, 3600.0))
+            ->needs(wait_flag);
+    kill_cmd->add_flag("--escalate", kill_escalate, "Send SIGKILL to processes still alive at the timeout")
+            ->needs(wait_flag);
+    kill_cmd->callback([&kill_specs, &force, &kill_wait, &kill_timeout, &kill_escalate, &exit_code]() {
+        auto ports = expand_ports(kill_specs);
+        auto owners = platform::get_port_owners(ports);
+        auto results = platform::summarize_ports(owners, ports);
 
-        if (!info.is_in_use()) {
-            std::cout << "Port " << kill_port << " is not in use\n";
-            return;
+        // Each owning process is killed once, however many ports it holds
+        std::map<uint32_t, std::vector<const PortInfo*>> targets;
+        std::vector<PortInfo> busy;
+        for (const auto& info : results) {
+            if (!info.is_in_use()) continue;
+
+            busy.push_back(info);
+            if (info.process) {
+                targets[info.process->pid].push_back(&info);
+            } else {
+                std::cerr << "Could not find process information for port " << info.port << "\n";
+            }
         }
 
-        if (!info.process) {
-            std::cerr << "Could not find process information for port " << kill_port << "\n";
+        if (busy.empty()) {
+            if (ports.size() == 1) {
+                std::cout << "Port " << ports.front() << " is not in use\n";
+            } else {
+                std::cout << "None of the " << ports.size() << " ports are in use\n";
+            }
+            return;
+        }
+        // Busy, but no owner to signal (another user's process without root)
+        if (targets.empty()) {
+            exit_code = 1;
             return;
         }
 
         if (!force) {
-            OutputFormatter::print_port_info(info);
-            std::cout << "\nKill this process? (y/N): ";
+            if (busy.size() == 1) {
+                OutputFormatter::print_port_info(busy.front());
+                std::cout << "\nKill this process? (y/N): ";
+            } else {
+                OutputFormatter::print_port_summary(busy);
+                std::cout << "\nKill " << targets.size()
+                          << (targets.size() == 1 ? " process" : " processes") << "? (y/N): ";
+            }
             std::string response;
             std::getline(std::cin, response);
             if (response != "y" && response != "Y") {
@@ -64,11 +454,35 @@ int main(int argc, char** argv) {
             }
         }
 
+        if (kill_wait) {
+            if (!kill_and_wait(targets, owners, kill_timeout, kill_escalate)) exit_code = 1;
+            return;
+        }
+
         ProcessManager pm;
-        if (pm.terminate_process(info.process->pid)) {
-            std::cout << "Process killed successfully\n";
-        } else {
-            std::cerr << "Failed to kill process (permission denied?)\n";
+        for (const auto& [pid, held] : targets) {
+            bool killed = pm.terminate_process(pid);
+            if (targets.size() == 1 && busy.size() == 1) {
+                if (killed) {
+                    std::cout << "Process killed successfully\n";
+                } else {
+                    std::cerr << "Failed to kill process (permission denied?)\n";
+                }
+            } else {
+                std::string held_ports = held.size() == 1 ? "port " : "ports ";
+                for (const auto* info : held) {
+                    if (info != held.front()) held_ports += ",";
+                    held_ports += std::to_string(info->port);
+                }
+                if (killed) {
+                    std::cout << "Killed " << held.front()->process->name << " (PID " << pid
+                              << ", " << held_ports << ")\n";
+                } else {
+                    std::cerr << "Failed to kill " << held.front()->process->name << " (PID " << pid
+                              << ", " << held_ports << "): permission denied?\n";
+                }
+            }
+            if (!killed) exit_code = 1;
         }
     });
 
@@ -78,31 +492,357 @@ int main(int argc, char** argv) {
     suggest_cmd->add_option("-n,--count", count, "Number of ports to suggest")
                ->check(CLI::Range(1, 20));
     suggest_cmd->callback([&count]() {
-        PortScanner scanner;
-        auto ports = scanner.suggest_free_ports(static_cast<size_t>(count));
+        auto ports = suggest_ports(static_cast<size_t>(count));
         OutputFormatter::print_suggested_ports(ports);
     });
 
     // LIST command
     auto* list_cmd = app.add_subcommand("list", "List all active ports");
-    list_cmd->callback([]() {
-        PortScanner scanner;
-        auto ports = scanner.get_all_active_ports();
-        OutputFormatter::print_active_ports(ports);
+    bool list_group = false;
+    list_cmd->add_flag("-g,--group", list_group,
+                       "Group sockets by address and port, with each one's receive queue");
+    list_cmd->callback([&format, &list_group]() {
+        use_process_fields(platform::PROCESS_NAME | platform::PROCESS_COMMAND_LINE |
+                           platform::PROCESS_USER);
+        auto table = platform::get_socket_table();
+        profiler::Phase phase("output");
+        if (format == OutputFormat::TEXT && list_group) {
+            OutputFormatter::print_socket_groups(table, platform::group_by_address(table));
+        } else if (format == OutputFormat::TEXT) {
+            OutputFormatter::print_active_sockets(table);
+        } else {
+            OutputFormatter::write_sockets(table, format);
+        }
+    });
+
+    // PORTS command
+    auto* ports_cmd = app.add_subcommand("ports", "List ports held by a process, name or user");
+    platform::ProcessSelector selector;
+    ports_cmd->add_option("-p,--pid", selector.pid, "Process ID")
+             ->check(CLI::PositiveNumber);
+    ports_cmd->add_option("--name", selector.name, "Process name (e.g. nginx)");
+    ports_cmd->add_option("-u,--user", selector.user, "User name or uid");
+    ports_cmd->require_option(1, 0);
+    ports_cmd->callback([&selector, &format]() {
+        use_process_fields(platform::PROCESS_NAME | platform::PROCESS_COMMAND_LINE |
+                           platform::PROCESS_USER);
+        auto table = platform::get_process_sockets(selector);
+        profiler::Phase phase("output");
+        if (format == OutputFormat::TEXT) {
+            OutputFormatter::print_active_sockets(table);
+        } else {
+            OutputFormatter::write_sockets(table, format);
+        }
     });
 
     // INFO command
     auto* info_cmd = app.add_subcommand("info", "Detailed port information");
-    int info_port = 0;
-    info_cmd->add_option("port", info_port, "Port number")
+    std::vector<std::string> info_specs;
+    info_cmd->add_option("ports", info_specs, "Ports or ranges")
             ->required()
-            ->check(CLI::Range(1, 65535));
-    info_cmd->callback([&info_port]() {
-        PortScanner scanner;
-        auto info = scanner.check_port(static_cast<uint16_t>(info_port));
-        OutputFormatter::print_detailed_info(info);
+            ->check(port_spec);
+    info_cmd->callback([&info_specs, &format]() {
+        auto ports = expand_ports(info_specs);
+        auto table = platform::get_port_sockets(ports);
+        auto results = platform::summarize_ports(table, ports);
+        profiler::Phase phase("output");
+        if (format != OutputFormat::TEXT) {
+            OutputFormatter::write_ports(results, format);
+            return;
+        }
+
+        if (results.size() == 1) {
+            OutputFormatter::print_detailed_info(results.front());
+        } else {
+            OutputFormatter::print_detailed_infos(results);
+        }
+
+        // SO_REUSEPORT groups and sockets held by several processes: show every owner
+        std::vector<platform::SocketGroup> shared;
+        for (auto& group : platform::group_by_address(table)) {
+            if (group.size() > 1 || table.holder_count(group.front()) > 1) {
+                shared.push_back(std::move(group));
+            }
+        }
+        if (!shared.empty()) {
+            std::cout << "\nShared listeners:\n";
+            OutputFormatter::print_socket_groups(table, shared);
+        }
+    });
+
+    // TOP command
+    auto* top_cmd = app.add_subcommand("top", "Live TCP connection counts per listening port");
+    double top_interval = 1.0;
+    int top_count = 0;
+    size_t top_rows = 20;
+    top_cmd->add_option("-i,--interval", top_interval, "Seconds between refreshes")
+           ->check(CLI::Range(0.1, 3600.0));
+    top_cmd->add_option("-n,--count", top_count, "Stop after N refreshes (0 = run forever)")
+           ->check(CLI::NonNegativeNumber);
+    top_cmd->add_option("-r,--rows", top_rows, "Ports to show, busiest first (0 = all)");
+    top_cmd->callback([&top_interval, &top_count, &top_rows]() {
+        ConnectionAggregator aggregator;
+        auto interval = std::chrono::duration<double>(top_interval);
+
+        // Redraw in place on a terminal; otherwise append frames like `top -b`
+#ifdef PLATFORM_WINDOWS
+        bool terminal = false;
+#else
+        bool terminal = isatty(STDOUT_FILENO);
+#endif
+
+        for (int tick = 0; top_count == 0 || tick < top_count; tick++) {
+            if (tick > 0) std::this_thread::sleep_for(interval);
+
+            auto start = std::chrono::steady_clock::now();
+            const auto& ports = aggregator.sample();
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+
+            if (terminal) {
+                std::cout << "\033[H\033[2J";
+            } else if (tick > 0) {
+                std::cout << "\n";
+            }
+            OutputFormatter::print_connection_stats(ports, aggregator.sockets(), ms, top_rows);
+        }
     });
 
+    // EPHEMERAL command
+    auto* ephemeral_cmd = app.add_subcommand("ephemeral",
+                                             "Outbound connections against the ephemeral port range");
+    size_t ephemeral_rows = 10;
+    ephemeral_cmd->add_option("-r,--rows", ephemeral_rows,
+                              "Destinations and processes to show (0 = all)");
+    ephemeral_cmd->callback([&ephemeral_rows]() {
+        use_process_fields(platform::PROCESS_NAME);
+        auto report = analyze_ephemeral_ports(ephemeral_rows == 0 ? SIZE_MAX : ephemeral_rows);
+        profiler::Phase phase("output");
+        OutputFormatter::print_ephemeral_report(report, ephemeral_rows);
+    });
+
+    // BACKLOG command
+    auto* backlog_cmd = app.add_subcommand("backlog", "Accept queue fill of listening TCP sockets");
+    std::vector<std::string> backlog_specs;
+    double backlog_threshold = 0;
+    double backlog_interval = 0.01;
+    int backlog_count = 0;
+    backlog_cmd->add_option("ports", backlog_specs, "Ports or ranges (default: every listener)")
+               ->check(port_spec);
+    auto* threshold_opt = backlog_cmd->add_option("-t,--threshold", backlog_threshold,
+                              "Sample until a queue reaches this percentage of its backlog, then exit 1")
+               ->check(CLI::Range(1.0, 100.0));
+    backlog_cmd->add_option("-i,--interval", backlog_interval,
+                            "Seconds between samples with --threshold (default 0.01)")
+               ->check(CLI::Range(0.001, 3600.0));
+    backlog_cmd->add_option("-n,--count", backlog_count,
+                            "Stop after N samples with --threshold (0 = until saturated)")
+               ->check(CLI::NonNegativeNumber);
+    backlog_cmd->callback([&backlog_specs, &backlog_threshold, &backlog_interval, &backlog_count,
+                           threshold_opt, &exit_code]() {
+        use_process_fields(platform::PROCESS_NAME);
+        auto ports = expand_ports(backlog_specs);
+        if (threshold_opt->count() == 0) {
+            auto queues = get_listener_queues(ports);
+            profiler::Phase phase("output");
+            OutputFormatter::print_listener_queues(queues);
+            return;
+        }
+
+        if (!platform::backlogs_reported()) {
+            throw std::runtime_error("--threshold needs backlog limits, which only the "
+                                     "netlink backend reports");
+        }
+
+        AcceptQueueSampler sampler(ports);
+        auto interval = std::chrono::duration<double>(backlog_interval);
+        platform::SocketEntry peak;
+        double peak_fill = -1;
+
+        int tick = 0;
+        for (; backlog_count == 0 || tick < backlog_count; tick++) {
+            if (tick > 0) std::this_thread::sleep_for(interval);
+
+            const auto& listeners = sampler.sample();
+
+            std::vector<platform::SocketEntry> saturated;
+            for (const auto& listener : listeners) {
+                double fill = queue_fill(listener);
+                if (fill > peak_fill) {
+                    peak_fill = fill;
+                    peak = listener;
+                }
+                if (fill >= backlog_threshold) saturated.push_back(listener);
+            }
+
+            if (!saturated.empty()) {
+                OutputFormatter::print_backlog_alerts(resolve_listener_owners(saturated));
+                exit_code = 1;
+                return;
+            }
+        }
+
+        std::cout << "No accept queue reached " << backlog_threshold << "% in " << tick
+                  << (tick == 1 ? " sample" : " samples");
+        if (peak_fill >= 0) {
+            std::cout << " (peak " << std::lround(peak_fill) << "% on port " << peak.port << ")";
+        }
+        std::cout << "\n";
+    });
+
+    // WATCH command
+    auto* watch_cmd = app.add_subcommand("watch", "Monitor listening ports, print changes as JSON lines");
+    double watch_interval = 1.0;
+    int watch_count = 0;
+    watch_cmd->add_option("-i,--interval", watch_interval, "Seconds between polls")
+             ->check(CLI::Range(0.01, 3600.0));
+    watch_cmd->add_option("-n,--count", watch_count, "Stop after N polls (0 = run forever)")
+             ->check(CLI::NonNegativeNumber);
+    watch_cmd->callback([&watch_interval, &watch_count]() {
+        PortWatcher watcher;
+        auto interval = std::chrono::duration<double>(watch_interval);
+
+        for (int tick = 0; watch_count == 0 || tick < watch_count; tick++) {
+            if (tick > 0) std::this_thread::sleep_for(interval);
+            OutputFormatter::print_watch_events(watcher.poll());
+        }
+    });
+
+    // WAIT-LISTEN / WAIT-FREE commands
+    std::vector<std::string> wait_specs;
+    double wait_timeout = 30.0;
+    for (bool listening : {true, false}) {
+        auto* wait_cmd = listening
+            ? app.add_subcommand("wait-listen", "Block until ports are listening")
+            : app.add_subcommand("wait-free", "Block until ports are free");
+        wait_cmd->add_option("ports", wait_specs, "Ports or ranges")
+                ->required()
+                ->check(port_spec);
+        wait_cmd->add_option("-t,--timeout", wait_timeout,
+                             "Give up after this many seconds (0 = wait forever, default 30)")
+                ->check(CLI::Range(0.0, 86400.0));
+        wait_cmd->callback([listening, &wait_specs, &wait_timeout, &exit_code]() {
+            if (!wait_for_ports(expand_ports(wait_specs), listening, wait_timeout)) exit_code = 1;
+        });
+    }
+
+#ifndef PLATFORM_WINDOWS
+    // LEASE command
+    auto* lease_cmd = app.add_subcommand("lease", "Reserve free ports for parallel jobs (via a local daemon)");
+    LeaseServerConfig lease_config;
+    lease_config.socket_path = default_lease_socket_path();
+    std::string lease_range = "10000-32767";
+    int lease_count = 1;
+    int lease_ttl = 300;
+    int lease_idle_exit = 0;
+    bool lease_bound = false;
+    bool lease_serve = false;
+    bool lease_status = false;
+    std::vector<std::string> lease_command;
+    lease_cmd->add_option("-n,--count", lease_count, "Number of ports to reserve")
+             ->check(CLI::Range(1, 1024));
+    lease_cmd->add_option("--ttl", lease_ttl,
+                          "Seconds to hold the ports when no command is given")
+             ->check(CLI::Range(1, 86400));
+    lease_cmd->add_flag("--bound", lease_bound,
+                        "Pass the command a socket already bound to the port as fd 3");
+    lease_cmd->add_flag("--serve", lease_serve, "Run the lease daemon in the foreground");
+    lease_cmd->add_flag("--status", lease_status, "Show the daemon's lease counts");
+    lease_cmd->add_option("--socket", lease_config.socket_path, "Daemon socket path");
+    lease_cmd->add_option("--range", lease_range, "Ports the daemon hands out")
+             ->check(port_spec);
+    lease_cmd->add_option("--idle-exit", lease_idle_exit,
+                          "Daemon exits after this many idle seconds (0 = never)")
+             ->group("");
+    lease_cmd->add_option("command", lease_command,
+                          "Command to run holding the ports (after --)");
+    lease_cmd->callback([&]() {
+        std::vector<uint16_t> range;
+        parse_port_spec(lease_range, range);
+        lease_config.first_port = range.front();
+        lease_config.last_port = range.back();
+
+        if (lease_serve) {
+            lease_config.idle_exit = std::chrono::seconds(lease_idle_exit);
+            LeaseServer server(lease_config);
+            if (!server.listen()) {
+                std::cerr << "A lease daemon is already serving " << lease_config.socket_path << "\n";
+                exit_code = 1;
+                return;
+            }
+            server.run();
+            return;
+        }
+
+        if (lease_bound && (lease_command.empty() || lease_count != 1)) {
+            throw std::runtime_error("--bound needs a command and a single port");
+        }
+
+        // Start a daemon on demand; it exits once idle for ten minutes
+        char self[4096];
+        ssize_t self_len = readlink("/proc/self/exe", self, sizeof(self) - 1);
+        std::string exe = self_len > 0 ? std::string(self, static_cast<size_t>(self_len)) : argv[0];
+        std::vector<std::string> spawn_argv{exe, "lease", "--serve",
+                                            "--socket", lease_config.socket_path,
+                                            "--range", lease_range, "--idle-exit", "600"};
+
+        LeaseClient client;
+        if (!client.connect(lease_config.socket_path, spawn_argv)) {
+            throw std::runtime_error("Cannot reach the lease daemon at " + lease_config.socket_path);
+        }
+
+        if (lease_status) {
+            std::cout << client.status() << "\n";
+            return;
+        }
+
+        if (lease_command.empty()) {
+            for (uint16_t port : client.lease(static_cast<size_t>(lease_count),
+                                              std::chrono::seconds(lease_ttl))) {
+                std::cout << port << "\n";
+            }
+            return;
+        }
+
+        // The lease lasts as long as the daemon connection, which the command
+        // inherits across exec
+        std::string ports_text;
+        if (lease_bound) {
+            uint16_t port = 0;
+            int socket_fd = client.lease_bound_socket(port);
+            if (client.fd() == 3) {
+                // Keep the connection open when fd 3 is taken for the socket
+                int moved = fcntl(client.fd(), F_DUPFD, 4);
+                fcntl(moved, F_SETFD, 0);
+            }
+            if (socket_fd != 3) {
+                dup2(socket_fd, 3);
+                close(socket_fd);
+            }
+            fcntl(3, F_SETFD, 0);
+            setenv("LISTEN_FDS", "1", 1);
+            setenv("LISTEN_PID", std::to_string(getpid()).c_str(), 1);
+            ports_text = std::to_string(port);
+        } else {
+            for (uint16_t port : client.lease(static_cast<size_t>(lease_count),
+                                              std::chrono::seconds(0))) {
+                ports_text += (ports_text.empty() ? "" : " ") + std::to_string(port);
+            }
+        }
+        if (client.fd() != 3) fcntl(client.fd(), F_SETFD, 0);
+
+        setenv("PORT", ports_text.substr(0, ports_text.find(' ')).c_str(), 1);
+        setenv("ZOHD_PORTS", ports_text.c_str(), 1);
+
+        std::vector<char*> command_argv;
+        for (auto& arg : lease_command) command_argv.push_back(arg.data());
+        command_argv.push_back(nullptr);
+        execvp(command_argv[0], command_argv.data());
+        throw std::runtime_error("Cannot run " + lease_command.front() + ": " +
+                                 std::strerror(errno));
+    });
+#endif
+
     // FIX command (interactive)
     auto* fix_cmd = app.add_subcommand("fix", "Interactive port conflict resolution");
     int fix_port = 0;
@@ -147,7 +887,7 @@ int main(int argc, char** argv) {
                 break;
             }
             case 2: {
-                auto suggestions = scanner.suggest_free_ports(3);
+                auto suggestions = suggest_ports(3);
                 std::cout << "\nAvailable alternative ports:\n";
                 for (auto port : suggestions) {
                     std::cout << "  " << port << "\n";
@@ -162,11 +902,22 @@ int main(int argc, char** argv) {
         }
     });
 
+    int status = 0;
     try {
         CLI11_PARSE(app, argc, argv);
+        status = exit_code;
     } catch (const CLI::ParseError& e) {
         return app.exit(e);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        status = 2;
+    }
+
+    if (profile) profiler::print_summary(std::cerr);
+    if (!trace_path.empty() && !profiler::write_trace(trace_path)) {
+        std::cerr << "Error: could not write trace to " << trace_path << "\n";
+        status = 2;
     }
 
-    return 0;
+    return status;
 }
@@ -1,11 +1,18 @@
 #ifdef PLATFORM_LINUX
 
 #include "platform_interface.hpp"
+#include "linux_internal.hpp"
+#include "socket_snapshot.hpp"
+#include "socket_table.hpp"
+#include "proc_net_parser.hpp"
+#include "../core/profiler.hpp"
 #include <fstream>
 #include <sstream>
 #include <ctime>
 #include <signal.h>
 #include <unistd.h>
+#include <poll.h>
+#include <sys/syscall.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -13,13 +20,19 @@
 #include <pwd.h>
 #include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace zohd {
 namespace platform {
 
-// Helper function to find PID by socket inode
-static uint32_t find_pid_by_inode(unsigned long inode);
-
 // Helper function to trim whitespace
 static std::string trim(const std::string& str) {
     size_t first = str.find_first_not_of(" \t\n\r");
@@ -28,158 +41,623 @@ static std::string trim(const std::string& str) {
     return str.substr(first, (last - first + 1));
 }
 
-bool is_port_in_use(uint16_t port) {
+static PlatformOptions g_options;
+
+// Set once the auto backend has fallen back to procfs for some protocol
+static bool g_procfs_fallback = false;
+
+void set_options(const PlatformOptions& options) {
+    g_options = options;
+}
+
+const PlatformOptions& get_options() {
+    return g_options;
+}
+
+// Parse <net_dir>/unix for listening and bound sockets
+static void read_procfs_unix_sockets(ProcNetParser& parser, const std::string& net_dir,
+                                     std::vector<SocketEntry>& out) {
+    if (!parser.load((net_dir + "/unix").c_str())) return;
+
+    parser.for_each_unix([&](const ProcNetUnixRow& row) {
+        // __SO_ACCEPTCON marks listeners; datagram servers are bound and unconnected
+        bool listening = (row.flags & 0x10000) != 0;
+        bool bound_dgram = row.type == SOCK_DGRAM && row.state == 1 && !row.path.empty();
+        if (!listening && !bound_dgram) return;
+
+        SocketEntry entry;
+        entry.protocol = Protocol::UNIX;
+        entry.inode = row.inode;
+        entry.path = std::string(row.path);
+        out.push_back(std::move(entry));
+    });
+}
+
+// Parse <net_dir>/<proto> and <net_dir>/<proto>6: LISTEN rows for TCP,
+// unconnected (CLOSE) rows for UDP and UDP-Lite, as `ss -lu` shows; a
+// connected client socket is not a service. port == 0 means every port.
+// net_dir is /proc/net, or /proc/<pid>/net for another network namespace.
+static void read_procfs_sockets(const std::string& net_dir, Protocol protocol, uint16_t port,
+                                std::vector<SocketEntry>& out) {
+    profiler::Phase phase("procfs_tables");
+    ProcNetParser parser;
+
+    if (protocol == Protocol::UNIX) {
+        if (port == 0) read_procfs_unix_sockets(parser, net_dir, out);
+        return;
+    }
+
+    const char* name = protocol_name(protocol);
+    uint32_t states = state_bit(protocol == Protocol::TCP ? TCP_STATE_LISTEN : TCP_STATE_CLOSE);
+
     // Check both IPv4 and IPv6
-    std::vector<std::string> tcp_files = {"/proc/net/tcp", "/proc/net/tcp6"};
+    for (bool ipv6 : {false, true}) {
+        std::string path = net_dir + "/" + name + (ipv6 ? "6" : "");
+        if (!parser.load(path.c_str())) continue;
+
+        parser.for_each(states, [&](const ProcNetRow& row) {
+            if (row.local_port == 0) return;
+            if (port != 0 && row.local_port != port) return;
+
+            SocketEntry entry;
+            entry.protocol = protocol;
+            entry.port = row.local_port;
+            entry.ipv6 = ipv6;
+            entry.uid = row.uid;
+            entry.inode = row.inode;
+            entry.address = row.local_addr;
+            entry.rx_queue = row.rx_queue;
+            entry.tx_queue = row.tx_queue;
+            out.push_back(entry);
+        });
+    }
+}
 
-    for (const auto& tcp_file : tcp_files) {
-        std::ifstream file(tcp_file);
-        if (!file.is_open()) continue;
+// A network namespace and one process inside it
+struct NetNamespace {
+    uint64_t inode;
+    uint32_t pid;
+};
 
-        std::string line;
-        std::getline(file, line);  // Skip header
-
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            std::string sl;  // Read as string since it has a colon (e.g., "0:")
-            std::string local_address, rem_address, st;
-
-            iss >> sl >> local_address >> rem_address >> st;
-
-            // Parse local address (format: "0100007F:0BB8" for 127.0.0.1:3000)
-            size_t colon_pos = local_address.find(':');
-            if (colon_pos != std::string::npos && colon_pos + 1 < local_address.size()) {
-                std::string port_hex = local_address.substr(colon_pos + 1);
-                if (!port_hex.empty()) {
-                    try {
-                        uint16_t local_port = std::stoul(port_hex, nullptr, 16);
-
-                        // Check if LISTENING (state 0A)
-                        if (local_port == port && st == "0A") {
-                            return true;
-                        }
-                    } catch (const std::exception&) {
-                        // Invalid port format, skip this entry
-                        continue;
-                    }
-                }
+static uint64_t netns_inode(const std::string& proc_dir) {
+    struct stat st;
+    if (stat((proc_dir + "/ns/net").c_str(), &st) != 0) return 0;
+    return st.st_ino;
+}
+
+// Distinct network namespaces other than our own, each with the first PID
+// found in it. One stat() per process; each namespace's tables are then
+// read once through its representative.
+static std::vector<NetNamespace> list_other_net_namespaces(uint64_t own) {
+    profiler::Phase phase("netns_scan");
+    std::vector<NetNamespace> result;
+    std::unordered_set<uint64_t> seen{own};
+
+    for (uint32_t pid : list_pids()) {
+        uint64_t inode = netns_inode(g_options.proc_root + "/" + std::to_string(pid));
+        if (inode != 0 && seen.insert(inode).second) result.push_back({inode, pid});
+    }
+    return result;
+}
+
+// Our own namespace, through sock_diag when allowed. sock_diag always sees
+// the live kernel, so a substitute proc_root is read as procfs.
+static void read_own_sockets(uint32_t protocols, uint16_t port, std::vector<SocketEntry>& out) {
+    bool live_proc = g_options.proc_root == "/proc";
+
+    for (Protocol protocol : {Protocol::TCP, Protocol::UDP, Protocol::UDPLITE, Protocol::UNIX}) {
+        if ((protocols & protocol_bit(protocol)) == 0) continue;
+
+        if (g_options.backend != SocketBackend::PROCFS && live_proc) {
+            if (sock_diag_sockets(protocol, port, out)) continue;
+
+            if (g_options.backend == SocketBackend::NETLINK) {
+                throw std::runtime_error(std::string("NETLINK_SOCK_DIAG is not available for ") +
+                                         protocol_name(protocol) + " on this kernel");
             }
+            g_procfs_fallback = true;
         }
-    }
 
-    return false;
+        read_procfs_sockets(g_options.proc_root + "/net", protocol, port, out);
+    }
 }
 
-std::vector<PortInfo> get_tcp_connections() {
-    std::vector<PortInfo> result;
-    std::vector<std::string> tcp_files = {"/proc/net/tcp", "/proc/net/tcp6"};
+std::vector<SocketEntry> get_sockets(uint32_t protocols, uint16_t port) {
+    profiler::Phase phase("socket_tables");
+    std::vector<SocketEntry> result;
+    read_own_sockets(protocols, port, result);
 
-    for (const auto& tcp_file : tcp_files) {
-        std::ifstream file(tcp_file);
-        if (!file.is_open()) continue;
+    if (!g_options.all_netns) return result;
 
-        std::string line;
-        std::getline(file, line);  // Skip header
-
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            std::string sl;  // Read as string since it has a colon (e.g., "0:")
-            std::string local_address, rem_address, st;
-            unsigned long inode = 0;
-            int uid;
-
-            // Parse line: sl local_address rem_address st tx_queue rx_queue tr tm->when retrnsmt uid timeout inode
-            iss >> sl >> local_address >> rem_address >> st;
-
-            // Skip tx_queue:rx_queue, tr, tm->when, retrnsmt
-            std::string skip;
-            for (int i = 0; i < 4; i++) iss >> skip;
-
-            iss >> uid >> skip >> inode;
-
-            // Only LISTENING state (0A)
-            if (st == "0A") {
-                size_t colon_pos = local_address.find(':');
-                if (colon_pos != std::string::npos && colon_pos + 1 < local_address.size()) {
-                    std::string port_hex = local_address.substr(colon_pos + 1);
-                    if (!port_hex.empty()) {
-                        try {
-                            uint16_t port_num = std::stoul(port_hex, nullptr, 16);
-
-                            PortInfo info;
-                            info.port = port_num;
-                            info.status = PortStatus::IN_USE;
-
-                            // Find PID by inode
-                            uint32_t pid = find_pid_by_inode(inode);
-                            if (pid > 0) {
-                                info.process = get_process_info(pid);
-                            }
-
-                            result.push_back(info);
-                        } catch (const std::exception&) {
-                            // Invalid port format, skip this entry
-                            continue;
-                        }
-                    }
-                }
+    uint64_t own = netns_inode(g_options.proc_root + "/self");
+    for (auto& entry : result) entry.netns = own;
+
+    // Other namespaces: sock_diag only sees the caller's namespace, but
+    // /proc/<pid>/net shows the tables of the namespace <pid> lives in
+    for (const auto& ns : list_other_net_namespaces(own)) {
+        size_t start = result.size();
+        std::string net_dir = g_options.proc_root + "/" + std::to_string(ns.pid) + "/net";
+        for (Protocol protocol : {Protocol::TCP, Protocol::UDP, Protocol::UDPLITE, Protocol::UNIX}) {
+            if (protocols & protocol_bit(protocol)) {
+                read_procfs_sockets(net_dir, protocol, port, result);
             }
         }
+        for (size_t i = start; i < result.size(); i++) {
+            result[i].netns = ns.inode;
+            result[i].other_netns = true;
+        }
     }
 
     return result;
 }
 
-static uint32_t find_pid_by_inode(unsigned long inode) {
-    if (inode == 0) return 0;
+bool port_queries_filtered() {
+    return g_options.backend != SocketBackend::PROCFS && g_options.proc_root == "/proc" &&
+           !g_options.all_netns && !g_procfs_fallback;
+}
+
+bool backlogs_reported() {
+    if (g_options.backend == SocketBackend::PROCFS || g_options.proc_root != "/proc") return false;
 
-    DIR* proc_dir = opendir("/proc");
-    if (!proc_dir) return 0;
+    if (g_options.backend == SocketBackend::AUTO && !g_procfs_fallback) {
+        std::vector<SocketEntry> probe;
+        if (!sock_diag_sockets(Protocol::TCP, 0, probe)) g_procfs_fallback = true;
+    }
+    return !g_procfs_fallback;
+}
+
+std::unordered_map<unsigned long, uint32_t> find_socket_owners(
+        const std::vector<unsigned long>& inodes) {
+    std::unordered_set<unsigned long> wanted(inodes.begin(), inodes.end());
+    wanted.erase(0);
+    return build_inode_pid_index(wanted, g_options.jobs);
+}
+
+bool is_port_in_use(uint16_t port) {
+    return current_snapshot().is_listening(port);
+}
 
-    struct dirent* entry;
-    while ((entry = readdir(proc_dir))) {
-        if (entry->d_type == DT_DIR && std::isdigit(entry->d_name[0])) {
-            uint32_t pid = 0;
-            try {
-                pid = std::stoul(entry->d_name);
-            } catch (const std::exception&) {
-                continue;
+// Cgroup path of a process: the unified (v2) hierarchy when present,
+// otherwise the systemd v1 hierarchy
+static std::string read_cgroup(uint32_t pid) {
+    std::ifstream file(g_options.proc_root + "/" + std::to_string(pid) + "/cgroup");
+    if (file) profiler::count(profiler::FILES_OPENED);
+    std::string line, fallback;
+
+    while (std::getline(file, line)) {
+        // hierarchy-ID:controller-list:cgroup-path
+        size_t first = line.find(':');
+        size_t second = first == std::string::npos ? first : line.find(':', first + 1);
+        if (second == std::string::npos) continue;
+
+        std::string path = line.substr(second + 1);
+        if (line.compare(0, 3, "0::") == 0) return path;
+        if (fallback.empty() || line.find("name=systemd") != std::string::npos) fallback = path;
+    }
+    return fallback;
+}
+
+// Short container id (first 12 hex digits, as docker prints it) if the
+// cgroup path contains a 64-digit container id
+static std::string container_id(const std::string& cgroup) {
+    size_t run = 0;
+    for (size_t i = 0; i < cgroup.size(); i++) {
+        if (std::isxdigit(static_cast<unsigned char>(cgroup[i]))) {
+            if (++run == 64) return cgroup.substr(i + 1 - 64, 12);
+        } else {
+            run = 0;
+        }
+    }
+    return "";
+}
+
+// Append `entries` to `table` with every process holding each socket,
+// reading each holder's details once
+static void fill_socket_table(SocketTable& table, const std::vector<const SocketEntry*>& entries,
+                              const InodeHolderIndex& holders_of) {
+    // Every holder's files are loaded in one batch, in order of first use
+    std::vector<uint32_t> pids;
+    std::unordered_set<uint32_t> seen;
+    for (const SocketEntry* entry : entries) {
+        auto it = holders_of.find(entry->inode);
+        if (it == holders_of.end()) continue;
+        for (uint32_t pid : it->second) {
+            if (table.find_process(pid) == SocketTable::NO_PROCESS && seen.insert(pid).second) {
+                pids.push_back(pid);
             }
+        }
+    }
+
+    std::unordered_map<uint32_t, std::string> containers;
+    for (const ProcessInfo& info : get_process_infos(pids, g_options.process_fields)) {
+        table.add_process(info);
+        if (g_options.all_netns) containers.emplace(info.pid, container_id(read_cgroup(info.pid)));
+    }
+
+    table.reserve(entries.size());
+    for (const SocketEntry* entry : entries) {
+        auto it = holders_of.find(entry->inode);
+        if (it == holders_of.end() || it->second.empty()) {
+            table.add(*entry, SocketTable::NO_PROCESS);
+            continue;
+        }
 
-            std::string fd_path = std::string("/proc/") + entry->d_name + "/fd";
-            DIR* fd_dir = opendir(fd_path.c_str());
-            if (fd_dir) {
-                struct dirent* fd_entry;
-                while ((fd_entry = readdir(fd_dir))) {
-                    std::string fd_name = fd_entry->d_name;
-                    if (fd_name == "." || fd_name == "..") continue;
-
-                    char link_target[256];
-                    std::string link_path = fd_path + "/" + fd_name;
-                    ssize_t len = readlink(link_path.c_str(), link_target, sizeof(link_target) - 1);
-                    if (len > 0) {
-                        link_target[len] = '\0';
-                        std::string target(link_target);
-
-                        // Check if matches "socket:[inode]"
-                        std::string search = "socket:[" + std::to_string(inode) + "]";
-                        if (target == search) {
-                            closedir(fd_dir);
-                            closedir(proc_dir);
-                            return pid;
-                        }
-                    }
-                }
-                closedir(fd_dir);
+        uint32_t pid = it->second.front();
+        std::string_view container;
+        if (g_options.all_netns) container = containers[pid];
+        table.add(*entry, table.find_process(pid), container);
+        for (size_t i = 1; i < it->second.size(); i++) {
+            table.add_holder(table.find_process(it->second[i]));
+        }
+    }
+}
+
+SocketTable get_socket_table() {
+    const auto& sockets = current_snapshot().entries();
+
+    // Resolve every socket's holders with one shared walk over /proc
+    std::unordered_set<unsigned long> wanted;
+    for (const auto& entry : sockets) {
+        if (entry.inode != 0) wanted.insert(entry.inode);
+    }
+    InodeHolderIndex index = build_inode_holder_index(wanted, g_options.jobs);
+
+    std::vector<const SocketEntry*> entries;
+    entries.reserve(sockets.size());
+    for (const auto& entry : sockets) entries.push_back(&entry);
+
+    SocketTable table;
+    fill_socket_table(table, entries, index);
+    return table;
+}
+
+SocketTable get_process_sockets(const ProcessSelector& selector) {
+    bool by_user = !selector.user.empty();
+    uid_t uid = 0;
+    if (by_user) {
+        if (selector.user.find_first_not_of("0123456789") == std::string::npos) {
+            // strtoull saturates on overflow, so one range check covers long input
+            errno = 0;
+            unsigned long long value = std::strtoull(selector.user.c_str(), nullptr, 10);
+            if (errno == ERANGE || value > UINT32_MAX) {
+                throw std::runtime_error("Unknown user: " + selector.user);
             }
+            uid = static_cast<uid_t>(value);
+        } else {
+            struct passwd* pw = getpwnam(selector.user.c_str());
+            if (!pw) throw std::runtime_error("Unknown user: " + selector.user);
+            uid = pw->pw_uid;
+        }
+    }
+
+    // Narrow the candidates with the cheapest test first: /proc/<pid> is
+    // owned by the process's effective uid, then the name needs a cmdline read
+    std::vector<uint32_t> candidates =
+        selector.pid != 0 ? std::vector<uint32_t>{selector.pid} : list_pids();
+    InodeHolderIndex holders_of;
+    for (uint32_t pid : candidates) {
+        if (by_user) {
+            struct stat st;
+            std::string proc_path = g_options.proc_root + "/" + std::to_string(pid);
+            if (stat(proc_path.c_str(), &st) != 0 || st.st_uid != uid) continue;
+        }
+        if (!selector.name.empty() && get_process_info(pid, PROCESS_NAME).name != selector.name) {
+            continue;
+        }
+
+        for (unsigned long inode : socket_inodes_of(pid)) {
+            auto& holders = holders_of[inode];
+            if (holders.empty() || holders.back() != pid) holders.push_back(pid);
+        }
+    }
+
+    SocketTable table;
+    if (holders_of.empty()) return table;
+
+    std::vector<const SocketEntry*> entries;
+    for (const auto& entry : current_snapshot().entries()) {
+        if (holders_of.count(entry.inode)) entries.push_back(&entry);
+    }
+    fill_socket_table(table, entries, holders_of);
+    return table;
+}
+
+void for_each_tcp_connection(const std::function<void(const TcpConnection&)>& fn) {
+    if (g_options.backend != SocketBackend::PROCFS && g_options.proc_root == "/proc") {
+        if (sock_diag_tcp_connections(fn)) return;
+
+        if (g_options.backend == SocketBackend::NETLINK) {
+            throw std::runtime_error("NETLINK_SOCK_DIAG is not available for tcp on this kernel");
+        }
+    }
+
+    profiler::Phase phase("procfs_tables");
+
+    // Both tables stay loaded so listeners of either family come first. The
+    // parsers live on between calls, so a periodic caller reuses their buffers.
+    static ProcNetParser parsers[2];
+    bool loaded[2];
+    for (int ipv6 = 0; ipv6 < 2; ipv6++) {
+        std::string path = g_options.proc_root + (ipv6 ? "/net/tcp6" : "/net/tcp");
+        loaded[ipv6] = parsers[ipv6].load(path.c_str());
+    }
+
+    TcpConnection connection;
+    for (uint32_t states : {state_bit(TCP_STATE_LISTEN), ALL_STATES & ~state_bit(TCP_STATE_LISTEN)}) {
+        for (int ipv6 = 0; ipv6 < 2; ipv6++) {
+            if (!loaded[ipv6]) continue;
+
+            connection.ipv6 = ipv6 != 0;
+            parsers[ipv6].for_each(states, [&](const ProcNetRow& row) {
+                if (row.state == 0 || row.state >= TCP_STATE_COUNT) return;
+                connection.state = static_cast<TcpState>(row.state);
+                connection.local_port = row.local_port;
+                connection.remote_port = row.remote_port;
+                connection.remote_address = row.remote_addr;
+                connection.rx_queue = row.rx_queue;
+                connection.tx_queue = row.tx_queue;
+                connection.inode = row.inode;
+                fn(connection);
+            });
         }
     }
+}
+
+EphemeralRange get_ephemeral_range() {
+    EphemeralRange range;
+    std::string sysctl = g_options.proc_root + "/sys/net/ipv4/";
+
+    std::ifstream range_file(sysctl + "ip_local_port_range");
+    unsigned first = 0;
+    unsigned last = 0;
+    if (range_file >> first >> last && first <= last && last <= 65535) {
+        range.first = static_cast<uint16_t>(first);
+        range.last = static_cast<uint16_t>(last);
+    }
 
-    closedir(proc_dir);
-    return 0;
+    // "8080,9000-9100"
+    std::ifstream reserved_file(sysctl + "ip_local_reserved_ports");
+    std::string item;
+    while (std::getline(reserved_file, item, ',')) {
+        unsigned low = 0;
+        unsigned high = 0;
+        int fields = std::sscanf(item.c_str(), "%u-%u", &low, &high);
+        if (fields < 1) continue;
+        if (fields == 1) high = low;
+        if (low > high || high > 65535) continue;
+        range.reserved.emplace_back(static_cast<uint16_t>(low), static_cast<uint16_t>(high));
+    }
+
+    return range;
 }
 
-ProcessInfo get_process_info(uint32_t pid) {
+std::vector<PortInfo> get_tcp_connections() {
+    SocketTable table = get_socket_table();
+
+    std::vector<PortInfo> result;
+    for (size_t row = 0; row < table.size(); row++) {
+        if (table.protocol(row) == Protocol::UNIX) continue;
+
+        PortInfo info;
+        info.port = table.port(row);
+        info.status = PortStatus::IN_USE;
+        if (const ProcessRecord* record = table.process(row)) {
+            info.process = record->to_process_info();
+        }
+        result.push_back(std::move(info));
+    }
+
+    return result;
+}
+
+// Sockets bound to `ports`. With all_holders every process holding each
+// socket is found, which takes a full walk of /proc; otherwise one owner
+// per socket is, and the sockets' uids narrow the processes worth reading.
+static SocketTable port_sockets(const std::vector<uint16_t>& ports, bool all_holders) {
+    const SocketSnapshot& snapshot = current_snapshot();
+
+    std::unordered_set<uint16_t> seen;
+    std::vector<const SocketEntry*> entries;
+    std::unordered_map<unsigned long, uint32_t> wanted;
+    for (uint16_t port : ports) {
+        if (!seen.insert(port).second) continue;
+        for (const auto& entry : snapshot.find(port)) {
+            entries.push_back(&entry);
+            if (entry.inode != 0) wanted.emplace(entry.inode, entry.uid);
+        }
+    }
+
+    InodeHolderIndex index;
+    if (all_holders) {
+        std::unordered_set<unsigned long> inodes;
+        for (const auto& [inode, uid] : wanted) inodes.insert(inode);
+        index = build_inode_holder_index(inodes, g_options.jobs);
+    } else {
+        for (const auto& [inode, pid] : find_owners_pruned(wanted, g_options.jobs)) {
+            index[inode].push_back(pid);
+        }
+    }
+
+    SocketTable table;
+    fill_socket_table(table, entries, index);
+    return table;
+}
+
+SocketTable get_port_sockets(const std::vector<uint16_t>& ports) {
+    return port_sockets(ports, true);
+}
+
+SocketTable get_port_owners(const std::vector<uint16_t>& ports) {
+    return port_sockets(ports, false);
+}
+
+std::vector<PortInfo> check_ports(const std::vector<uint16_t>& ports) {
+    return summarize_ports(get_port_owners(ports), ports);
+}
+
+// Unix time the system booted, read from <proc_root>/uptime once per run
+static double boot_time_seconds() {
+    static const double boot_time = []() {
+        double uptime_seconds = 0;
+        std::ifstream uptime_file(g_options.proc_root + "/uptime");
+        if (!(uptime_file >> uptime_seconds)) return 0.0;
+        return static_cast<double>(std::time(nullptr)) - uptime_seconds;
+    }();
+    return boot_time;
+}
+
+// Username for uid; getpwuid() may go through NSS/LDAP, so results are memoized
+static const std::string& user_name(uid_t uid) {
+    static std::unordered_map<uid_t, std::string> cache;
+
+    auto it = cache.find(uid);
+    if (it != cache.end()) return it->second;
+
+    std::string name;
+    struct passwd* pw = nullptr;
+    if (!g_options.numeric_users) {
+        profiler::Phase phase("getpwuid");
+        pw = getpwuid(uid);
+    }
+    if (pw) {
+        name = pw->pw_name;
+    } else {
+        name = std::to_string(uid);
+    }
+    return cache.emplace(uid, std::move(name)).first->second;
+}
+
+// The /proc/<pid> files process metadata is read from
+enum ProcFile : size_t { STAT_FILE, CMDLINE_FILE, STATUS_FILE, PROC_FILE_COUNT };
+
+static const char* const PROC_FILE_NAMES[PROC_FILE_COUNT] = {"/stat", "/cmdline", "/status"};
+
+// Bytes of each file the batch loader reads; enough for everything used
+// on any ordinary process, and a file cut short is read again in full
+constexpr size_t PROC_FILE_LIMIT = 1024;
+
+// Processes below which a ring is not worth setting up
+constexpr size_t URING_MIN_PROCESSES = 16;
+
+// Reads one of a process's files, returning false if it cannot be opened
+using ProcFileReader = std::function<bool(ProcFile file, std::string& text)>;
+
+// The part of `file` that is used: the first line of stat, the first
+// argument of cmdline, status up to the Uid line
+static bool read_proc_file(const std::string& proc_path, ProcFile file, std::string& text) {
+    std::ifstream in(proc_path + PROC_FILE_NAMES[file]);
+    if (!in.is_open()) return false;
+    profiler::count(profiler::FILES_OPENED);
+
+    text.clear();
+    if (file == STAT_FILE) {
+        std::getline(in, text);
+    } else if (file == CMDLINE_FILE) {
+        std::getline(in, text, '\0');
+    } else {
+        std::string line;
+        while (std::getline(in, line)) {
+            text += line;
+            text += '\n';
+            if (line.compare(0, 4, "Uid:") == 0) break;
+        }
+    }
+    profiler::count(profiler::BYTES_READ, text.size());
+    return true;
+}
+
+// Cut a prefix read by the batch loader down to what read_proc_file()
+// returns. False if the part that is used may be longer than the prefix.
+static bool trim_proc_file(ProcFile file, std::string& data) {
+    bool whole = data.size() < PROC_FILE_LIMIT;
+    size_t end = std::string::npos;
+    if (file == STAT_FILE) {
+        end = data.find('\n');
+    } else if (file == CMDLINE_FILE) {
+        end = data.find('\0');
+    } else {
+        size_t uid = data.compare(0, 4, "Uid:") == 0 ? 0 : data.find("\nUid:");
+        if (uid != std::string::npos) {
+            end = data.find('\n', uid + 1);
+            if (end != std::string::npos) end++;
+        }
+    }
+
+    if (end != std::string::npos) {
+        data.resize(end);
+        return true;
+    }
+    return whole;
+}
+
+// starttime (field 22) of a /proc/<pid>/stat line in clock ticks since boot, 0 if malformed
+static uint64_t parse_start_ticks(const std::string& line) {
+    // Format: pid (comm) state ppid pgrp session tty_nr tpgid flags ...
+    // comm may contain spaces and parentheses, so count from the last ')'
+    size_t last_paren = line.rfind(')');
+    if (last_paren == std::string::npos) return 0;
+
+    std::istringstream iss(line.substr(last_paren + 1));
+    std::string field;
+    int field_num = 2;  // pid and (comm) are behind us
+    while (field_num < 22 && iss >> field) {
+        field_num++;
+    }
+    if (field_num != 22) return 0;
+
+    try {
+        return std::stoull(field);
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+// Real uid from the Uid line of /proc/<pid>/status
+static bool parse_status_uid(const std::string& status, uint32_t& uid) {
+    size_t line = status.compare(0, 4, "Uid:") == 0 ? 0 : status.find("\nUid:");
+    if (line == std::string::npos) return false;
+
+    std::istringstream iss(status.substr(line == 0 ? 0 : line + 1));
+    std::string label;
+    return static_cast<bool>(iss >> label >> uid);
+}
+
+// Unix time of a process start given in clock ticks since boot
+static uint64_t start_time_from_ticks(uint64_t start_ticks) {
+    // Boot time and clock ticks are per-host constants
+    static const long clock_ticks = sysconf(_SC_CLK_TCK);
+    double boot_time = boot_time_seconds();
+    if (start_ticks == 0 || boot_time <= 0 || clock_ticks <= 0) return 0;
+    return static_cast<uint64_t>(boot_time + static_cast<double>(start_ticks) / clock_ticks);
+}
+
+// Executable name from the first cmdline argument
+static std::string process_name(const std::string& cmdline) {
+    std::string name = cmdline.substr(cmdline.find_last_of('/') + 1);
+    return name.substr(0, name.find(' '));
+}
+
+// Bits of the cached fields that stand for a resolved user
+static uint32_t user_bits() {
+    return g_options.numeric_users ? CACHED_UID : PROCESS_USER;
+}
+
+// Whether `fields` needs the stat file, and which of cmdline and status
+// it needs given what the PID cache already holds (`have`)
+static bool needs_stat(uint32_t fields) {
+    return (fields & PROCESS_START_TIME) || pid_cache_enabled();
+}
+
+static bool needs_cmdline(uint32_t fields, uint32_t have) {
+    return (fields & (PROCESS_NAME | PROCESS_COMMAND_LINE)) && !(have & PROCESS_COMMAND_LINE);
+}
+
+static bool needs_status(uint32_t fields, uint32_t have) {
+    return (fields & PROCESS_USER) && !(have & user_bits());
+}
+
+// get_process_info() with the files coming from `read`
+static ProcessInfo build_process_info(uint32_t pid, uint32_t fields, const ProcFileReader& read) {
     ProcessInfo info;
     info.pid = pid;
     info.start_time = 0;
@@ -187,103 +665,118 @@ ProcessInfo get_process_info(uint32_t pid) {
     info.command_line = "";
     info.user = "";
 
-    // Read /proc/<pid>/cmdline
-    std::string cmdline_path = "/proc/" + std::to_string(pid) + "/cmdline";
-    std::ifstream cmdline_file(cmdline_path);
-    if (cmdline_file) {
-        std::string cmdline;
-        std::getline(cmdline_file, cmdline, '\0');
-        if (!cmdline.empty()) {
-            info.command_line = cmdline;
-
-            // Extract process name from command
-            size_t last_slash = cmdline.find_last_of('/');
-            if (last_slash != std::string::npos) {
-                info.name = cmdline.substr(last_slash + 1);
-                // Remove any null terminators or spaces
-                size_t space_pos = info.name.find_first_of(" \0");
-                if (space_pos != std::string::npos) {
-                    info.name = info.name.substr(0, space_pos);
-                }
-            } else {
-                info.name = cmdline;
-                size_t space_pos = info.name.find_first_of(" \0");
-                if (space_pos != std::string::npos) {
-                    info.name = info.name.substr(0, space_pos);
-                }
-            }
-        }
+    // The start time tells this process apart from earlier holders of the
+    // PID, so with the cache on it is read first, and for a process seen
+    // by an earlier run it is the only file read
+    uint64_t start_ticks = 0;
+    std::string text;
+    if (needs_stat(fields) && read(STAT_FILE, text)) start_ticks = parse_start_ticks(text);
+    if (fields & PROCESS_START_TIME) info.start_time = start_time_from_ticks(start_ticks);
+    bool use_cache = pid_cache_enabled() && start_ticks != 0;
+
+    CachedProcess cached;
+    if (use_cache) pid_cache_lookup(pid, start_ticks, cached);
+    uint32_t have = cached.fields;
+
+    // The name is derived from the command line
+    if (needs_cmdline(fields, have) && read(CMDLINE_FILE, cached.command_line)) {
+        cached.fields |= PROCESS_NAME | PROCESS_COMMAND_LINE;
+    }
+    if ((fields & (PROCESS_NAME | PROCESS_COMMAND_LINE)) && !cached.command_line.empty()) {
+        if (fields & PROCESS_COMMAND_LINE) info.command_line = cached.command_line;
+        info.name = process_name(cached.command_line);
     }
 
-    // Read /proc/<pid>/stat for start time
-    std::string stat_path = "/proc/" + std::to_string(pid) + "/stat";
-    std::ifstream stat_file(stat_path);
-    if (stat_file) {
-        std::string line;
-        std::getline(stat_file, line);
-
-        // Parse stat file (22nd field is starttime in jiffies since boot)
-        // Format: pid (comm) state ppid pgrp session tty_nr tpgid flags ...
-        size_t last_paren = line.rfind(')');
-        if (last_paren != std::string::npos) {
-            std::istringstream iss(line.substr(last_paren + 1));
-            std::string field;
-            int field_num = 3;  // We've already parsed pid and (comm)
-
-            // Field 22 is starttime (we need to skip to field 22)
-            while (field_num < 22 && iss >> field) {
-                field_num++;
-            }
+    if (needs_status(fields, have) && read(STATUS_FILE, text) &&
+        parse_status_uid(text, cached.uid)) {
+        cached.fields |= CACHED_UID;
 
-            if (field_num == 22 && !field.empty()) {
-                try {
-                    unsigned long long starttime_jiffies = std::stoull(field);
-
-                    // Get system boot time
-                    std::ifstream uptime_file("/proc/uptime");
-                    if (uptime_file) {
-                        double uptime_seconds;
-                        uptime_file >> uptime_seconds;
-
-                        // Convert jiffies to seconds (assuming 100 jiffies per second)
-                        long clock_ticks = sysconf(_SC_CLK_TCK);
-                        double process_start_seconds = static_cast<double>(starttime_jiffies) / clock_ticks;
-
-                        // Calculate absolute start time
-                        auto now = std::time(nullptr);
-                        info.start_time = now - static_cast<uint64_t>(uptime_seconds - process_start_seconds);
-                    }
-                } catch (const std::exception&) {
-                    // Failed to parse start time, leave it as 0
-                }
-            }
+        // Only real names are worth keeping; numeric ones are free
+        if (!g_options.numeric_users) {
+            cached.user = user_name(cached.uid);
+            cached.fields |= PROCESS_USER;
         }
     }
+    if ((fields & PROCESS_USER) && (cached.fields & user_bits())) {
+        info.user = g_options.numeric_users ? std::to_string(cached.uid) : cached.user;
+    }
 
-    // Read /proc/<pid>/status for UID
-    std::string status_path = "/proc/" + std::to_string(pid) + "/status";
-    std::ifstream status_file(status_path);
-    if (status_file) {
-        std::string line;
-        while (std::getline(status_file, line)) {
-            if (line.substr(0, 4) == "Uid:") {
-                std::istringstream iss(line);
-                std::string label;
-                uid_t uid;
-                iss >> label >> uid;
-
-                struct passwd* pw = getpwuid(uid);
-                if (pw) {
-                    info.user = pw->pw_name;
-                } else {
-                    info.user = std::to_string(uid);
-                }
-                break;
+    if (use_cache && cached.fields != have) pid_cache_store(pid, start_ticks, cached);
+
+    return info;
+}
+
+ProcessInfo get_process_info(uint32_t pid, uint32_t fields) {
+    profiler::Phase phase("process_info");
+    const std::string proc_path = g_options.proc_root + "/" + std::to_string(pid);
+    return build_process_info(pid, fields, [&proc_path](ProcFile file, std::string& text) {
+        return read_proc_file(proc_path, file, text);
+    });
+}
+
+std::vector<ProcessInfo> get_process_infos(const std::vector<uint32_t>& pids, uint32_t fields) {
+    std::vector<ProcessInfo> infos;
+    infos.reserve(pids.size());
+    if (!g_options.io_uring || pids.size() < URING_MIN_PROCESSES) {
+        for (uint32_t pid : pids) infos.push_back(get_process_info(pid, fields));
+        return infos;
+    }
+    profiler::Phase phase("process_info_batch");
+
+    std::vector<std::string> proc_paths;
+    proc_paths.reserve(pids.size());
+    for (uint32_t pid : pids) proc_paths.push_back(g_options.proc_root + "/" + std::to_string(pid));
+
+    // Prefetched text of each PID's files, empty optional if not fetched
+    std::vector<std::array<std::optional<std::string>, PROC_FILE_COUNT>> prefetched(pids.size());
+    std::vector<FileRead> batch;
+    std::vector<std::pair<size_t, ProcFile>> owners;  // batch index -> PID index, file
+
+    auto queue = [&](size_t i, ProcFile file) {
+        FileRead read;
+        read.path = proc_paths[i] + PROC_FILE_NAMES[file];
+        read.limit = PROC_FILE_LIMIT;
+        batch.push_back(std::move(read));
+        owners.emplace_back(i, file);
+    };
+    auto fetch = [&]() {
+        uring_read_files(batch);
+        for (size_t j = 0; j < batch.size(); j++) {
+            auto [i, file] = owners[j];
+            if (batch[j].ok && trim_proc_file(file, batch[j].data)) {
+                prefetched[i][file] = std::move(batch[j].data);
             }
         }
+        batch.clear();
+        owners.clear();
+    };
+
+    // Stat files first: their start times decide what the cache supplies
+    if (needs_stat(fields)) {
+        for (size_t i = 0; i < pids.size(); i++) queue(i, STAT_FILE);
+        fetch();
     }
-
-    return info;
+    for (size_t i = 0; i < pids.size(); i++) {
+        CachedProcess cached;
+        const auto& stat = prefetched[i][STAT_FILE];
+        uint64_t start_ticks = stat ? parse_start_ticks(*stat) : 0;
+        if (pid_cache_enabled() && start_ticks != 0) pid_cache_lookup(pids[i], start_ticks, cached);
+
+        if (needs_cmdline(fields, cached.fields)) queue(i, CMDLINE_FILE);
+        if (needs_status(fields, cached.fields)) queue(i, STATUS_FILE);
+    }
+    fetch();
+
+    // Whatever the batch could not read is read the usual way
+    for (size_t i = 0; i < pids.size(); i++) {
+        infos.push_back(build_process_info(pids[i], fields, [&](ProcFile file, std::string& text) {
+            auto& data = prefetched[i][file];
+            if (!data) return read_proc_file(proc_paths[i], file, text);
+            text = std::move(*data);
+            return true;
+        }));
+    }
+    return infos;
 }
 
 bool terminate_process(uint32_t pid) {
@@ -294,6 +787,123 @@ bool force_kill_process(uint32_t pid) {
     return kill(static_cast<pid_t>(pid), SIGKILL) == 0;
 }
 
+namespace {
+
+// pidfd_open(2) (Linux 5.3+); -1 with errno ENOSYS on older kernels
+int open_pidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+    (void)pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+bool send_signal(int pidfd, pid_t pid, int signal) {
+#ifdef SYS_pidfd_send_signal
+    if (pidfd >= 0) return syscall(SYS_pidfd_send_signal, pidfd, signal, nullptr, 0) == 0;
+#endif
+    return kill(pid, signal) == 0;
+}
+
+} // namespace
+
+std::vector<StopResult> stop_processes(const std::vector<ProcessInfo>& processes, double timeout,
+                                       bool escalate) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    auto elapsed = [&start]() {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    std::vector<uint32_t> pids;
+    for (const auto& process : processes) pids.push_back(process.pid);
+
+    std::vector<StopResult> results(pids.size());
+    std::vector<int> pidfds(pids.size(), -1);
+    std::vector<size_t> pending;
+
+    for (size_t i = 0; i < pids.size(); i++) {
+        pid_t pid = static_cast<pid_t>(pids[i]);
+        results[i].pid = pids[i];
+        pidfds[i] = open_pidfd(pid);
+        if (pidfds[i] < 0 && errno == ESRCH) {
+            results[i].exited = true;  // Gone before we got to it
+            continue;
+        }
+
+        // The pidfd pins whatever holds the PID now; if that is not the
+        // process the scan saw, the original is gone and the PID reused
+        uint64_t scanned = processes[i].start_time;
+        if (scanned != 0 && get_process_info(pids[i], PROCESS_START_TIME).start_time != scanned) {
+            results[i].exited = true;
+            if (pidfds[i] >= 0) close(pidfds[i]);
+            pidfds[i] = -1;
+            continue;
+        }
+
+        results[i].signalled = send_signal(pidfds[i], pid, SIGTERM);
+        if (results[i].signalled) pending.push_back(i);
+    }
+
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                std::chrono::duration<double>(timeout));
+    bool killed = false;
+    std::vector<pollfd> fds;
+
+    while (!pending.empty()) {
+        auto now = Clock::now();
+        if (now >= deadline) {
+            if (!escalate || killed) break;
+
+            for (size_t i : pending) {
+                results[i].escalated = send_signal(pidfds[i], static_cast<pid_t>(pids[i]), SIGKILL);
+            }
+            killed = true;
+            deadline = now + std::chrono::seconds(1);
+            continue;
+        }
+
+        // A pidfd turns readable when its process exits. Without pidfds
+        // (old kernels), fall back to probing with signal 0 every 10ms.
+        fds.clear();
+        bool probing = false;
+        for (size_t i : pending) {
+            if (pidfds[i] >= 0) {
+                fds.push_back({pidfds[i], POLLIN, 0});
+            } else {
+                probing = true;
+            }
+        }
+
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1;
+        int wait_ms = static_cast<int>(probing ? std::min<long long>(left, 10) : left);
+        if (poll(fds.data(), fds.size(), wait_ms) < 0 && errno != EINTR) break;
+
+        size_t polled = 0;
+        double seconds = elapsed();
+        std::vector<size_t> still_pending;
+        for (size_t i : pending) {
+            bool gone = pidfds[i] >= 0
+                ? (fds[polled++].revents & (POLLIN | POLLHUP)) != 0
+                : kill(static_cast<pid_t>(pids[i]), 0) != 0 && errno == ESRCH;
+            if (gone) {
+                results[i].exited = true;
+                results[i].seconds = seconds;
+            } else {
+                still_pending.push_back(i);
+            }
+        }
+        pending.swap(still_pending);
+    }
+
+    for (int fd : pidfds) {
+        if (fd >= 0) close(fd);
+    }
+    return results;
+}
+
 std::string get_current_user() {
     uid_t uid = getuid();
     struct passwd* pw = getpwuid(uid);
@@ -308,6 +918,31 @@ bool is_process_alive(uint32_t pid) {
     return kill(static_cast<pid_t>(pid), 0) == 0;
 }
 
+int open_process_handle(uint32_t pid) {
+    return open_pidfd(static_cast<pid_t>(pid));
+}
+
+void close_process_handle(int handle) {
+    if (handle >= 0) close(handle);
+}
+
+std::vector<size_t> exited_process_handles(const std::vector<int>& handles) {
+    std::vector<size_t> exited;
+    std::vector<pollfd> fds;
+    std::vector<size_t> positions;
+    for (size_t i = 0; i < handles.size(); i++) {
+        if (handles[i] < 0) continue;
+        fds.push_back({handles[i], POLLIN, 0});
+        positions.push_back(i);
+    }
+    if (fds.empty() || poll(fds.data(), fds.size(), 0) <= 0) return exited;
+
+    for (size_t i = 0; i < fds.size(); i++) {
+        if (fds[i].revents & (POLLIN | POLLHUP)) exited.push_back(positions[i]);
+    }
+    return exited;
+}
+
 } // namespace platform
 } // namespace zohd
 
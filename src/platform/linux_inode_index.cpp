@@ -0,0 +1,312 @@
+#ifdef PLATFORM_LINUX
+
+#include "linux_internal.hpp"
+#include "../core/profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace zohd {
+namespace platform {
+
+namespace {
+
+// Parse a "socket:[12345]" link target without allocating. Returns 0 for
+// anything that is not a socket.
+unsigned long parse_socket_inode(const char* target, size_t len) {
+    static const char prefix[] = "socket:[";
+    const size_t prefix_len = sizeof(prefix) - 1;
+
+    if (len <= prefix_len + 1 || std::memcmp(target, prefix, prefix_len) != 0) return 0;
+    if (target[len - 1] != ']') return 0;
+
+    unsigned long inode = 0;
+    for (size_t i = prefix_len; i < len - 1; i++) {
+        if (!std::isdigit(static_cast<unsigned char>(target[i]))) return 0;
+        inode = inode * 10 + static_cast<unsigned long>(target[i] - '0');
+    }
+    return inode;
+}
+
+// Call on_socket(inode) for every socket fd of `pid`; stops when it returns false
+template <typename Fn>
+void for_each_socket_fd(uint32_t pid, Fn&& on_socket) {
+    std::string fd_path = get_options().proc_root + "/" + std::to_string(pid) + "/fd";
+    DIR* fd_dir = opendir(fd_path.c_str());
+    if (!fd_dir) return;
+    profiler::count(profiler::DIRS_SCANNED);
+
+    // readlinkat() against the fd directory avoids building a path per fd
+    int dir_fd = dirfd(fd_dir);
+    struct dirent* fd_entry;
+    while ((fd_entry = readdir(fd_dir))) {
+        if (fd_entry->d_name[0] == '.') continue;
+
+        char link_target[64];
+        ssize_t len = readlinkat(dir_fd, fd_entry->d_name, link_target, sizeof(link_target));
+        profiler::count(profiler::READLINKS);
+        if (len <= 0) continue;
+
+        unsigned long inode = parse_socket_inode(link_target, static_cast<size_t>(len));
+        if (inode != 0 && !on_socket(inode)) break;
+    }
+    closedir(fd_dir);
+}
+
+// Per-worker slice of the PID list. The owner pops from the front,
+// idle workers steal the back half.
+struct WorkQueue {
+    std::mutex mutex;
+    size_t next = 0;
+    size_t end = 0;
+
+    bool pop(size_t& index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (next >= end) return false;
+        index = next++;
+        return true;
+    }
+};
+
+bool steal(std::vector<WorkQueue>& queues, size_t self) {
+    WorkQueue& own = queues[self];
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        WorkQueue& victim = queues[(self + offset) % queues.size()];
+        std::scoped_lock lock(own.mutex, victim.mutex);
+
+        size_t remaining = victim.end > victim.next ? victim.end - victim.next : 0;
+        if (remaining < 2) continue;
+
+        size_t take = remaining / 2;
+        own.next = victim.end - take;
+        own.end = victim.end;
+        victim.end -= take;
+        return true;
+    }
+    return false;
+}
+
+// Inode -> (position of the PID in `pids`, PID) for each holder seen
+using PartialIndex = std::unordered_map<unsigned long, std::vector<std::pair<size_t, uint32_t>>>;
+
+// Walk the fd tables of `pids` in parallel and record who holds each inode
+// in `inodes`, ordered by position in `pids`. With first_only the workers
+// stop once every inode has a holder; otherwise every PID is visited.
+PartialIndex walk_fd_tables(const std::unordered_set<unsigned long>& inodes,
+                            const std::vector<uint32_t>& pids, unsigned jobs, bool first_only) {
+    PartialIndex merged;
+    if (inodes.empty() || pids.empty()) return merged;
+    profiler::Phase phase("fd_walk");
+
+    if (jobs == 0) jobs = std::max(1U, std::thread::hardware_concurrency());
+    size_t workers = std::min<size_t>(jobs, std::max<size_t>(1, pids.size()));
+
+    // Shared early-exit state: a claim flag per wanted inode
+    std::unordered_map<unsigned long, size_t> slot_of;
+    slot_of.reserve(inodes.size());
+    for (unsigned long inode : inodes) slot_of.emplace(inode, slot_of.size());
+    std::unique_ptr<std::atomic<bool>[]> claimed(new std::atomic<bool>[slot_of.size()]);
+    for (size_t i = 0; i < slot_of.size(); i++) claimed[i] = false;
+    std::atomic<size_t> found{0};
+
+    std::vector<WorkQueue> queues(workers);
+    for (size_t w = 0; w < workers; w++) {
+        queues[w].next = pids.size() * w / workers;
+        queues[w].end = pids.size() * (w + 1) / workers;
+    }
+
+    std::vector<PartialIndex> partials(workers);
+
+    auto run_worker = [&](size_t self) {
+        profiler::Phase worker_phase("fd_walk_worker");
+        PartialIndex& partial = partials[self];
+        size_t position;
+
+        while (!first_only || found.load(std::memory_order_relaxed) < slot_of.size()) {
+            if (!queues[self].pop(position) && !(steal(queues, self) && queues[self].pop(position))) {
+                break;
+            }
+
+            uint32_t pid = pids[position];
+            for_each_socket_fd(pid, [&](unsigned long inode) {
+                auto slot = slot_of.find(inode);
+                if (slot == slot_of.end()) return true;
+
+                // All of one PID's fds are visited back to back, so checking
+                // the last holder records a process holding the socket under
+                // several fds once
+                auto& holders = partial[inode];
+                if (holders.empty() || holders.back().first != position) {
+                    holders.emplace_back(position, pid);
+                }
+
+                if (first_only && !claimed[slot->second].exchange(true)) {
+                    return found.fetch_add(1) + 1 < slot_of.size();
+                }
+                return true;
+            });
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t w = 1; w < workers; w++) threads.emplace_back(run_worker, w);
+    run_worker(0);
+    for (auto& thread : threads) thread.join();
+
+    // Merge back into /proc order. With first_only the workers stop once
+    // every inode is claimed, so a holder earlier in /proc order that sat
+    // in an unvisited stretch can be missed.
+    merged = std::move(partials[0]);
+    for (size_t w = 1; w < workers; w++) {
+        for (auto& [inode, holders] : partials[w]) {
+            auto& all = merged[inode];
+            all.insert(all.end(), holders.begin(), holders.end());
+        }
+    }
+    if (workers > 1) {
+        for (auto& [inode, holders] : merged) std::sort(holders.begin(), holders.end());
+    }
+    return merged;
+}
+
+} // namespace
+
+std::vector<uint32_t> list_pids() {
+    std::vector<uint32_t> pids;
+
+    DIR* proc_dir = opendir(get_options().proc_root.c_str());
+    if (!proc_dir) return pids;
+    profiler::count(profiler::DIRS_SCANNED);
+
+    struct dirent* entry;
+    while ((entry = readdir(proc_dir))) {
+        if (entry->d_type != DT_DIR || !std::isdigit(static_cast<unsigned char>(entry->d_name[0]))) {
+            continue;
+        }
+
+        char* end = nullptr;
+        unsigned long pid = std::strtoul(entry->d_name, &end, 10);
+        if (*end == '\0' && pid != 0) pids.push_back(static_cast<uint32_t>(pid));
+    }
+
+    closedir(proc_dir);
+    return pids;
+}
+
+std::vector<unsigned long> socket_inodes_of(uint32_t pid) {
+    std::vector<unsigned long> inodes;
+    for_each_socket_fd(pid, [&inodes](unsigned long inode) {
+        inodes.push_back(inode);
+        return true;
+    });
+    return inodes;
+}
+
+InodePidIndex build_inode_pid_index(const std::unordered_set<unsigned long>& inodes,
+                                    unsigned jobs) {
+    if (inodes.empty()) return {};
+    return build_inode_pid_index(inodes, list_pids(), jobs);
+}
+
+InodePidIndex build_inode_pid_index(const std::unordered_set<unsigned long>& inodes,
+                                    const std::vector<uint32_t>& pids, unsigned jobs) {
+    InodePidIndex index;
+    auto walked = walk_fd_tables(inodes, pids, jobs, true);
+    index.reserve(walked.size());
+    for (const auto& [inode, holders] : walked) index.emplace(inode, holders.front().second);
+    return index;
+}
+
+InodeHolderIndex build_inode_holder_index(const std::unordered_set<unsigned long>& inodes,
+                                          unsigned jobs) {
+    InodeHolderIndex index;
+    if (inodes.empty()) return index;
+
+    auto walked = walk_fd_tables(inodes, list_pids(), jobs, false);
+    index.reserve(walked.size());
+    for (const auto& [inode, holders] : walked) {
+        auto& pids = index[inode];
+        pids.reserve(holders.size());
+        for (const auto& holder : holders) pids.push_back(holder.second);
+    }
+    return index;
+}
+
+InodePidIndex find_owners_pruned(const std::unordered_map<unsigned long, uint32_t>& sockets,
+                                 unsigned jobs) {
+    InodePidIndex index;
+    std::unordered_set<unsigned long> remaining;
+    for (const auto& [inode, uid] : sockets) {
+        if (inode != 0) remaining.insert(inode);
+    }
+    auto record = [&](const InodePidIndex& found) {
+        for (const auto& [inode, pid] : found) {
+            index.emplace(inode, pid);
+            remaining.erase(inode);
+        }
+    };
+
+    // 1. The owner an earlier run saw, confirmed against its fd table
+    std::unordered_set<uint32_t> hinted;
+    for (const auto& [inode, uid] : sockets) {
+        uint32_t pid = owner_hint(inode);
+        if (pid == 0 || !remaining.count(inode) || !hinted.insert(pid).second) continue;
+
+        for_each_socket_fd(pid, [&](unsigned long held) {
+            if (remaining.erase(held)) index.emplace(held, pid);
+            return !remaining.empty();
+        });
+    }
+
+    // 2. Processes running as a remaining socket's uid: /proc/<pid> is owned
+    // by the process's effective uid, so one fstatat() rules a process out
+    // without touching its fd table. The rest are kept for step 3.
+    std::vector<uint32_t> others;
+    if (!remaining.empty()) {
+        std::unordered_set<uint32_t> uids;
+        for (unsigned long inode : remaining) uids.insert(sockets.at(inode));
+
+        std::vector<uint32_t> candidates;
+        int proc_fd = open(get_options().proc_root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        char name[16];
+        for (uint32_t pid : list_pids()) {
+            if (hinted.count(pid)) continue;
+
+            struct stat st;
+            std::snprintf(name, sizeof(name), "%u", pid);
+            if (proc_fd >= 0 && fstatat(proc_fd, name, &st, 0) == 0 && uids.count(st.st_uid)) {
+                candidates.push_back(pid);
+            } else {
+                others.push_back(pid);
+            }
+        }
+        if (proc_fd >= 0) close(proc_fd);
+        record(build_inode_pid_index(remaining, candidates, jobs));
+    }
+
+    // 3. Sockets handed to processes of another user: walk the processes
+    // neither step above has already looked at
+    if (!remaining.empty()) record(build_inode_pid_index(remaining, others, jobs));
+
+    for (const auto& [inode, pid] : index) {
+        if (owner_hint(inode) != pid) store_owner_hint(inode, pid);
+    }
+    return index;
+}
+
+} // namespace platform
+} // namespace zohd
+
+#endif // PLATFORM_LINUX
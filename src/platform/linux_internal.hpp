@@ -0,0 +1,107 @@
+#pragma once
+
+// Linux-only helpers shared between the linux_*.cpp translation units.
+// Not part of the platform interface.
+
+#include "platform_interface.hpp"
+#include <functional>
+#include <vector>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace zohd {
+namespace platform {
+
+// Enumerate sockets of one protocol through NETLINK_SOCK_DIAG: listening
+// TCP sockets, bound and unconnected UDP/UDP-Lite sockets (IPv4 and
+// IPv6), or listening and bound Unix sockets. States and, when port != 0, the source port are
+// filtered in the kernel. Returns false if the protocol's diag module is
+// unavailable, in which case nothing is appended to `out`.
+bool sock_diag_sockets(Protocol protocol, uint16_t port, std::vector<SocketEntry>& out);
+
+// Every TCP socket through NETLINK_SOCK_DIAG, in for_each_tcp_connection()
+// order. Returns false if the inet diag module is unavailable; `fn` may
+// then already have seen some listeners.
+bool sock_diag_tcp_connections(const std::function<void(const TcpConnection&)>& fn);
+
+// Numeric entries of /proc, in readdir order
+std::vector<uint32_t> list_pids();
+
+// Inodes of the sockets `pid` has open (reads only /proc/<pid>/fd)
+std::vector<unsigned long> socket_inodes_of(uint32_t pid);
+
+// Socket inode -> owning PID, built by a single walk over /proc/*/fd
+using InodePidIndex = std::unordered_map<unsigned long, uint32_t>;
+
+// Walk /proc/*/fd once and record the owner of each inode in `inodes`,
+// stopping as soon as all of them are found. With jobs > 1 the PID
+// directories are spread over that many threads.
+InodePidIndex build_inode_pid_index(const std::unordered_set<unsigned long>& inodes,
+                                    unsigned jobs = 1);
+
+// Same walk over `pids` only, in that order
+InodePidIndex build_inode_pid_index(const std::unordered_set<unsigned long>& inodes,
+                                    const std::vector<uint32_t>& pids, unsigned jobs = 1);
+
+// Socket inode -> every PID holding it, in /proc order. Preforked workers
+// share their parent's listening socket, and a reuseport master may hold
+// each of its workers' sockets as well.
+using InodeHolderIndex = std::unordered_map<unsigned long, std::vector<uint32_t>>;
+
+// Walk every /proc/*/fd to the end (no early exit, since any later process
+// may hold an inode too) and record all holders of each inode in `inodes`
+InodeHolderIndex build_inode_holder_index(const std::unordered_set<unsigned long>& inodes,
+                                          unsigned jobs = 1);
+
+// Owners of a few sockets (inode -> socket uid), cheapest search first: the
+// owner an earlier run recorded, then only processes whose effective uid
+// is a socket's uid, then a full walk for whatever is still missing.
+InodePidIndex find_owners_pruned(const std::unordered_map<unsigned long, uint32_t>& sockets,
+                                 unsigned jobs = 1);
+
+// One file for uring_read_files(): its first `limit` bytes
+struct FileRead {
+    std::string path;
+    size_t limit = 4096;
+    bool ok = false;   // Opened and read; `data` may still be a prefix
+    std::string data;
+};
+
+// Open, read and close every file in `files` through io_uring, with one
+// system call per round of opens and one per round of reads. Returns false
+// if io_uring is unavailable (pre-5.6 kernel, io_uring_disabled, seccomp)
+// or failed part way; files not marked ok are then the caller's to read.
+bool uring_read_files(std::vector<FileRead>& files);
+
+// get_process_info() for many PIDs, in order. With PlatformOptions::io_uring
+// their /proc files are read through uring_read_files() in a few batches,
+// falling back to one by one when that is unavailable.
+std::vector<ProcessInfo> get_process_infos(const std::vector<uint32_t>& pids, uint32_t fields);
+
+// Process metadata kept across invocations by the PID cache
+struct CachedProcess {
+    uint32_t fields = 0;       // ProcessField bits held, plus CACHED_UID
+    uint32_t uid = 0;
+    std::string command_line;  // PROCESS_COMMAND_LINE (the name derives from it)
+    std::string user;          // PROCESS_USER: the resolved user name
+};
+
+// The uid is known even if no user name was resolved (--numeric-users)
+constexpr uint32_t CACHED_UID = 1U << 31;
+
+// Memory-mapped table of process metadata in $XDG_RUNTIME_DIR, keyed by
+// PID plus the starttime field of /proc/<pid>/stat, so a reused PID never
+// matches. Off (lookups miss, stores are dropped) with --no-cache, a
+// non-default proc_root, or no runtime dir.
+bool pid_cache_enabled();
+bool pid_cache_lookup(uint32_t pid, uint64_t start_ticks, CachedProcess& out);
+void pid_cache_store(uint32_t pid, uint64_t start_ticks, const CachedProcess& entry);
+
+// Last owner seen for a socket inode (0 if unknown), kept in the same file
+uint32_t owner_hint(unsigned long inode);
+void store_owner_hint(unsigned long inode, uint32_t pid);
+
+} // namespace platform
+} // namespace zohd
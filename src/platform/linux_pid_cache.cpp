@@ -0,0 +1,256 @@
+#ifdef PLATFORM_LINUX
+
+#include "linux_internal.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace zohd {
+namespace platform {
+
+namespace {
+
+// File layout: one header, SLOT_COUNT fixed-size entries, then HINT_COUNT
+// owner hints. PIDs hash to a slot and probe up to PROBE_LIMIT neighbours;
+// the home slot is overwritten when all of them are taken. Hints are
+// direct-mapped by inode.
+constexpr char MAGIC[4] = {'Z', 'P', 'I', 'D'};
+constexpr uint32_t VERSION = 2;
+constexpr uint32_t SLOT_COUNT = 4096;
+constexpr uint32_t PROBE_LIMIT = 8;
+constexpr uint32_t HINT_COUNT = 1024;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t entry_size;
+    char boot_id[48];   // Entries from an earlier boot are discarded
+};
+
+struct Entry {
+    uint32_t pid;
+    uint32_t fields;        // 0 = empty slot
+    uint64_t start_ticks;
+    uint32_t uid;
+    uint32_t checksum;      // FNV-1a of the entry with this field zeroed
+    uint16_t command_line_size;
+    uint8_t user_size;
+    uint8_t reserved;
+    char user[32];
+    char command_line[452];
+};
+
+// Inode -> PID that held it. Only a search order hint: callers confirm it
+// against the PID's fd table.
+struct Hint {
+    uint64_t inode;
+    uint32_t pid;
+    uint32_t check;  // hint_check(inode, pid); rejects torn writes
+};
+
+static_assert(sizeof(Header) == 64, "PID cache header layout");
+static_assert(sizeof(Entry) == 512, "PID cache entry layout");
+static_assert(sizeof(Hint) == 16, "PID cache hint layout");
+
+constexpr size_t FILE_SIZE = sizeof(Header) + SLOT_COUNT * sizeof(Entry) + HINT_COUNT * sizeof(Hint);
+
+uint32_t hint_check(uint64_t inode, uint32_t pid) {
+    return static_cast<uint32_t>((inode * 0x9E3779B97F4A7C15ull) >> 32) ^ pid ^ 0x5A5A5A5Au;
+}
+
+// Readers take no lock: a torn entry fails its checksum and reads as a miss
+uint32_t checksum(const Entry& entry) {
+    Entry copy = entry;
+    copy.checksum = 0;
+
+    uint32_t hash = 2166136261u;
+    const auto* bytes = reinterpret_cast<const unsigned char*>(&copy);
+    for (size_t i = 0; i < sizeof(copy); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+struct Cache {
+    int fd = -1;
+    Header* header = nullptr;
+    Entry* entries = nullptr;
+    Hint* hints = nullptr;
+    std::mutex write_mutex;  // flock() does not exclude threads sharing the fd
+};
+
+std::string read_boot_id() {
+    std::ifstream file("/proc/sys/kernel/random/boot_id");
+    std::string id;
+    std::getline(file, id);
+    return id.substr(0, sizeof(Header::boot_id) - 1);
+}
+
+bool header_matches(const Header& header, const std::string& boot_id) {
+    return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+           header.version == VERSION && header.slot_count == SLOT_COUNT &&
+           header.entry_size == sizeof(Entry) && boot_id == header.boot_id;
+}
+
+// Map the cache file, (re)initializing it if it is new, from another
+// layout or from before a reboot. Returns nullptr if the cache is off.
+Cache* open_cache() {
+    const auto& options = get_options();
+    const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+    if (!options.pid_cache || options.proc_root != "/proc" || !runtime_dir || !*runtime_dir) {
+        return nullptr;
+    }
+
+    std::string path = std::string(runtime_dir) + "/zohd-pid-cache";
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, 0600);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_uid != getuid() ||
+        (static_cast<size_t>(st.st_size) != FILE_SIZE && ftruncate(fd, FILE_SIZE) != 0)) {
+        close(fd);
+        return nullptr;
+    }
+
+    void* map = mmap(nullptr, FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+
+    auto* cache = new Cache;
+    cache->fd = fd;
+    cache->header = static_cast<Header*>(map);
+    cache->entries = reinterpret_cast<Entry*>(static_cast<char*>(map) + sizeof(Header));
+    cache->hints = reinterpret_cast<Hint*>(cache->entries + SLOT_COUNT);
+
+    std::string boot_id = read_boot_id();
+    if (!header_matches(*cache->header, boot_id)) {
+        flock(fd, LOCK_EX);
+        if (!header_matches(*cache->header, boot_id)) {
+            std::memset(map, 0, FILE_SIZE);
+            Header header{};
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.slot_count = SLOT_COUNT;
+            header.entry_size = sizeof(Entry);
+            std::memcpy(header.boot_id, boot_id.data(), boot_id.size());
+            *cache->header = header;
+        }
+        flock(fd, LOCK_UN);
+    }
+    return cache;
+}
+
+Cache* cache() {
+    static Cache* instance = open_cache();  // Lives for the whole run
+    return instance;
+}
+
+uint32_t home_slot(uint32_t pid) {
+    return (pid * 2654435761u) % SLOT_COUNT;
+}
+
+} // namespace
+
+bool pid_cache_enabled() {
+    return cache() != nullptr;
+}
+
+bool pid_cache_lookup(uint32_t pid, uint64_t start_ticks, CachedProcess& out) {
+    Cache* c = cache();
+    if (!c) return false;
+
+    for (uint32_t probe = 0; probe < PROBE_LIMIT; probe++) {
+        Entry entry = c->entries[(home_slot(pid) + probe) % SLOT_COUNT];
+        if (entry.fields == 0) return false;
+        if (entry.pid != pid) continue;
+
+        // Same PID from another process lifetime, or a torn write
+        if (entry.start_ticks != start_ticks || entry.checksum != checksum(entry)) return false;
+
+        out.fields = entry.fields;
+        out.uid = entry.uid;
+        out.command_line.assign(entry.command_line, entry.command_line_size);
+        out.user.assign(entry.user, entry.user_size);
+        return true;
+    }
+    return false;
+}
+
+void pid_cache_store(uint32_t pid, uint64_t start_ticks, const CachedProcess& process) {
+    Cache* c = cache();
+    if (!c) return;
+
+    Entry entry{};
+    entry.pid = pid;
+    entry.start_ticks = start_ticks;
+    entry.fields = process.fields;
+    entry.uid = process.uid;
+
+    // Values that don't fit are left out and re-read next time
+    if (process.command_line.size() <= sizeof(entry.command_line)) {
+        entry.command_line_size = static_cast<uint16_t>(process.command_line.size());
+        std::memcpy(entry.command_line, process.command_line.data(), process.command_line.size());
+    } else {
+        entry.fields &= ~(PROCESS_NAME | PROCESS_COMMAND_LINE);
+    }
+    if (process.user.size() <= sizeof(entry.user)) {
+        entry.user_size = static_cast<uint8_t>(process.user.size());
+        std::memcpy(entry.user, process.user.data(), process.user.size());
+    } else {
+        entry.fields &= ~PROCESS_USER;
+    }
+    if (entry.fields == 0) return;
+    entry.checksum = checksum(entry);
+
+    std::lock_guard<std::mutex> lock(c->write_mutex);
+    flock(c->fd, LOCK_EX);
+
+    // Reuse this PID's slot or the first empty one; otherwise evict the
+    // home slot
+    Entry* target = &c->entries[home_slot(pid)];
+    for (uint32_t probe = 0; probe < PROBE_LIMIT; probe++) {
+        Entry* slot = &c->entries[(home_slot(pid) + probe) % SLOT_COUNT];
+        if (slot->fields == 0 || slot->pid == pid) {
+            target = slot;
+            break;
+        }
+    }
+    std::memcpy(target, &entry, sizeof(entry));
+
+    flock(c->fd, LOCK_UN);
+}
+
+uint32_t owner_hint(unsigned long inode) {
+    Cache* c = cache();
+    if (!c) return 0;
+
+    Hint hint = c->hints[inode % HINT_COUNT];
+    if (hint.inode != inode || hint.check != hint_check(hint.inode, hint.pid)) return 0;
+    return hint.pid;
+}
+
+void store_owner_hint(unsigned long inode, uint32_t pid) {
+    Cache* c = cache();
+    if (!c) return;
+
+    Hint hint{inode, pid, hint_check(inode, pid)};
+
+    std::lock_guard<std::mutex> lock(c->write_mutex);
+    flock(c->fd, LOCK_EX);
+    c->hints[inode % HINT_COUNT] = hint;
+    flock(c->fd, LOCK_UN);
+}
+
+} // namespace platform
+} // namespace zohd
+
+#endif // PLATFORM_LINUX
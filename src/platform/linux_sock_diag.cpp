@@ -0,0 +1,278 @@
+#ifdef PLATFORM_LINUX
+
+#include "linux_internal.hpp"
+#include "../core/profiler.hpp"
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#include <linux/unix_diag.h>
+
+namespace zohd {
+namespace platform {
+
+namespace {
+
+// Owns a netlink socket fd
+class NetlinkSocket {
+public:
+    NetlinkSocket() : fd_(socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG)) {}
+    ~NetlinkSocket() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    NetlinkSocket(const NetlinkSocket&) = delete;
+    NetlinkSocket& operator=(const NetlinkSocket&) = delete;
+
+    int fd() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+bool send_request(int fd, const void* msg, size_t len) {
+    struct sockaddr_nl kernel;
+    std::memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+
+    ssize_t sent = sendto(fd, msg, len, 0,
+                          reinterpret_cast<const struct sockaddr*>(&kernel), sizeof(kernel));
+    return sent == static_cast<ssize_t>(len);
+}
+
+// Read dump replies until NLMSG_DONE, calling on_msg(nlh) for each
+// SOCK_DIAG_BY_FAMILY message. Returns false on a netlink error.
+template <typename Fn>
+bool read_dump(int fd, Fn&& on_msg) {
+    alignas(struct nlmsghdr) char buf[32768];
+
+    while (true) {
+        ssize_t len = recv(fd, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (len == 0) return false;
+        profiler::count(profiler::NETLINK_RECVS);
+        profiler::count(profiler::BYTES_READ, static_cast<uint64_t>(len));
+
+        int remaining = static_cast<int>(len);
+        for (auto* nlh = reinterpret_cast<struct nlmsghdr*>(buf);
+             NLMSG_OK(nlh, remaining);
+             nlh = NLMSG_NEXT(nlh, remaining)) {
+            if (nlh->nlmsg_type == NLMSG_DONE) return true;
+            if (nlh->nlmsg_type == NLMSG_ERROR) return false;
+            if (nlh->nlmsg_type == SOCK_DIAG_BY_FAMILY) on_msg(nlh);
+        }
+    }
+}
+
+// inet dump request: header, inet_diag request, optional source-port bytecode.
+// Layout follows what ss(8) sends for "sport = :N".
+struct InetDumpRequest {
+    struct nlmsghdr nlh;
+    struct inet_diag_req_v2 req;
+    struct nlattr bc_attr;
+    struct inet_diag_bc_op bc[2];
+};
+
+// Ask for a dump of one IP protocol and family, limited to the sockets in
+// `states` (a mask of 1 << TCP_*) and, when port != 0, that source port
+bool send_inet_dump(int fd, uint8_t ip_protocol, uint8_t family, uint32_t states, uint16_t port) {
+    InetDumpRequest msg;
+    std::memset(&msg, 0, sizeof(msg));
+
+    size_t len = offsetof(InetDumpRequest, bc_attr);
+    msg.req.sdiag_family = family;
+    msg.req.sdiag_protocol = ip_protocol;
+    msg.req.idiag_states = states;
+
+    if (port != 0) {
+        // S_EQ compares against the port stored in the following op's "no"
+        // field; yes jumps to the end (accept), no jumps past it (reject).
+        const uint16_t bc_len = sizeof(msg.bc);
+        msg.bc[0].code = INET_DIAG_BC_S_EQ;
+        msg.bc[0].yes = bc_len;
+        msg.bc[0].no = bc_len + 4;
+        msg.bc[1].no = port;
+
+        msg.bc_attr.nla_type = INET_DIAG_REQ_BYTECODE;
+        msg.bc_attr.nla_len = NLA_HDRLEN + bc_len;
+        len = sizeof(msg);
+    }
+
+    msg.nlh.nlmsg_len = static_cast<uint32_t>(len);
+    msg.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    msg.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+
+    return send_request(fd, &msg, len);
+}
+
+bool dump_inet(int fd, Protocol protocol, uint8_t family, uint16_t port,
+               std::vector<SocketEntry>& out) {
+    // TCP when listening, UDP only when unconnected (connected UDP sockets
+    // are ESTABLISHED; those are clients, not services)
+    uint8_t ip_protocol = IPPROTO_TCP;
+    uint32_t states = 1U << TCP_LISTEN;
+    if (protocol == Protocol::UDP || protocol == Protocol::UDPLITE) {
+        ip_protocol = protocol == Protocol::UDP ? IPPROTO_UDP : IPPROTO_UDPLITE;
+        states = 1U << TCP_CLOSE;
+    }
+    if (!send_inet_dump(fd, ip_protocol, family, states, port)) return false;
+
+    return read_dump(fd, [&](const struct nlmsghdr* nlh) {
+        const auto* diag = static_cast<const struct inet_diag_msg*>(NLMSG_DATA(nlh));
+
+        SocketEntry entry;
+        entry.protocol = protocol;
+        entry.port = ntohs(diag->id.idiag_sport);
+        entry.ipv6 = family == AF_INET6;
+        entry.uid = diag->idiag_uid;
+        entry.inode = diag->idiag_inode;
+        std::memcpy(entry.address.data(), diag->id.idiag_src, sizeof(diag->id.idiag_src));
+
+        // For listeners the kernel reports the backlog limit as wqueue;
+        // /proc/net/tcp prints 0 there, so match it and keep it apart
+        entry.rx_queue = diag->idiag_rqueue;
+        entry.tx_queue = protocol == Protocol::TCP ? 0 : diag->idiag_wqueue;
+        if (protocol == Protocol::TCP) entry.backlog = static_cast<int32_t>(diag->idiag_wqueue);
+        if (entry.port != 0) out.push_back(std::move(entry));
+    });
+}
+
+bool dump_unix(int fd, std::vector<SocketEntry>& out) {
+    struct {
+        struct nlmsghdr nlh;
+        struct unix_diag_req req;
+    } msg;
+    std::memset(&msg, 0, sizeof(msg));
+
+    msg.nlh.nlmsg_len = sizeof(msg);
+    msg.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    msg.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    msg.req.sdiag_family = AF_UNIX;
+    msg.req.udiag_states = (1U << TCP_LISTEN) | (1U << TCP_CLOSE);
+    msg.req.udiag_show = UDIAG_SHOW_NAME | UDIAG_SHOW_UID;
+
+    if (!send_request(fd, &msg, sizeof(msg))) return false;
+
+    return read_dump(fd, [&](const struct nlmsghdr* nlh) {
+        const auto* diag = static_cast<const struct unix_diag_msg*>(NLMSG_DATA(nlh));
+
+        SocketEntry entry;
+        entry.protocol = Protocol::UNIX;
+        entry.inode = diag->udiag_ino;
+
+        int attr_len = static_cast<int>(nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*diag)));
+        for (auto* attr = reinterpret_cast<const struct rtattr*>(diag + 1);
+             RTA_OK(attr, attr_len);
+             attr = RTA_NEXT(attr, attr_len)) {
+            const char* data = static_cast<const char*>(RTA_DATA(attr));
+            size_t size = RTA_PAYLOAD(attr);
+
+            if (attr->rta_type == UNIX_DIAG_NAME && size > 0) {
+                // Abstract names start with a NUL; show them as '@name' like ss(8)
+                if (data[0] == '\0') {
+                    entry.path = "@" + std::string(data + 1, size - 1);
+                } else {
+                    entry.path.assign(data, strnlen(data, size));
+                }
+            } else if (attr->rta_type == UNIX_DIAG_UID && size >= sizeof(uint32_t)) {
+                std::memcpy(&entry.uid, data, sizeof(uint32_t));
+            }
+        }
+
+        // Listening stream/seqpacket sockets, and datagram sockets bound to a name
+        bool listening = diag->udiag_state == TCP_LISTEN;
+        bool bound_dgram = diag->udiag_type == SOCK_DGRAM && !entry.path.empty();
+        if (listening || bound_dgram) out.push_back(std::move(entry));
+    });
+}
+
+// Pending connection requests (include/net/tcp_states.h, not in the uapi headers)
+constexpr uint8_t TCP_NEW_SYN_RECV = 12;
+
+// TCP sockets of one family in `states`, as TcpConnection rows
+bool dump_tcp(int fd, uint8_t family, uint32_t states,
+              const std::function<void(const TcpConnection&)>& fn) {
+    if (!send_inet_dump(fd, IPPROTO_TCP, family, states, 0)) return false;
+
+    TcpConnection row;
+    row.ipv6 = family == AF_INET6;
+    return read_dump(fd, [&](const struct nlmsghdr* nlh) {
+        const auto* diag = static_cast<const struct inet_diag_msg*>(NLMSG_DATA(nlh));
+
+        // Request sockets are dumped as NEW_SYN_RECV; /proc/net/tcp shows SYN_RECV
+        row.state = diag->idiag_state == TCP_NEW_SYN_RECV
+            ? TcpState::SYN_RECV : static_cast<TcpState>(diag->idiag_state);
+        row.local_port = ntohs(diag->id.idiag_sport);
+        row.remote_port = ntohs(diag->id.idiag_dport);
+        std::memcpy(row.remote_address.data(), diag->id.idiag_dst, sizeof(diag->id.idiag_dst));
+        row.rx_queue = diag->idiag_rqueue;
+        row.tx_queue = row.state == TcpState::LISTEN ? 0 : diag->idiag_wqueue;
+        row.inode = diag->idiag_inode;
+        fn(row);
+    });
+}
+
+} // namespace
+
+bool sock_diag_tcp_connections(const std::function<void(const TcpConnection&)>& fn) {
+    profiler::Phase phase("sock_diag");
+    NetlinkSocket sock;
+    if (sock.fd() < 0) return false;
+
+    // Listeners of both families before any connection. A missing IPv6
+    // family only means there are no IPv6 sockets.
+    const uint32_t listen = 1U << TCP_LISTEN;
+    if (!dump_tcp(sock.fd(), AF_INET, listen, fn)) return false;
+    bool ipv6 = dump_tcp(sock.fd(), AF_INET6, listen, fn);
+
+    if (!dump_tcp(sock.fd(), AF_INET, ~listen, fn)) return false;
+    if (ipv6) dump_tcp(sock.fd(), AF_INET6, ~listen, fn);
+    return true;
+}
+
+bool sock_diag_sockets(Protocol protocol, uint16_t port, std::vector<SocketEntry>& out) {
+    profiler::Phase phase("sock_diag");
+    NetlinkSocket sock;
+    if (sock.fd() < 0) return false;
+
+    size_t start = out.size();
+
+    if (protocol == Protocol::UNIX) {
+        if (port != 0) return true;
+        if (!dump_unix(sock.fd(), out)) {
+            out.resize(start);
+            return false;
+        }
+        return true;
+    }
+
+    // Same order as /proc/net/<proto> then /proc/net/<proto>6
+    if (!dump_inet(sock.fd(), protocol, AF_INET, port, out)) {
+        out.resize(start);
+        return false;
+    }
+
+    // Kernels built without IPv6 reject the AF_INET6 dump; that simply
+    // means there are no IPv6 sockets.
+    size_t ipv4_end = out.size();
+    if (!dump_inet(sock.fd(), protocol, AF_INET6, port, out)) {
+        out.resize(ipv4_end);
+    }
+
+    return true;
+}
+
+} // namespace platform
+} // namespace zohd
+
+#endif // PLATFORM_LINUX
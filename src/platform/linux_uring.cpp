@@ -0,0 +1,263 @@
+#ifdef PLATFORM_LINUX
+
+#include "linux_internal.hpp"
+#include "../core/profiler.hpp"
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace zohd {
+namespace platform {
+
+// IORING_FEAT_RW_CUR_POS arrived with IORING_OP_OPENAT, READ and CLOSE (5.6)
+#if defined(SYS_io_uring_setup) && defined(SYS_io_uring_enter) && defined(IORING_FEAT_RW_CUR_POS)
+
+namespace {
+
+// Ring size. Every round opens up to RING_FILES files with one submission,
+// then reads and closes them (two entries each) with a second one.
+constexpr unsigned RING_ENTRIES = 256;
+constexpr unsigned RING_FILES = RING_ENTRIES / 2;
+
+// user_data of a close; its read carries the plain file index
+constexpr uint64_t CLOSE_TAG = 1ull << 63;
+
+// Cleared by the first setup failure, so later calls skip straight to the
+// caller's fallback
+std::atomic<bool> g_available{true};
+
+// One io_uring instance with its submission and completion rings mapped
+class Ring {
+public:
+    Ring() {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd_ = static_cast<int>(syscall(SYS_io_uring_setup, RING_ENTRIES, &params));
+        if (fd_ < 0) return;
+        if (!(params.features & IORING_FEAT_RW_CUR_POS) || !map(params)) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    ~Ring() {
+        if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+        if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+        if (fd_ >= 0) close(fd_);
+    }
+
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    bool ok() const { return fd_ >= 0; }
+
+    // Next free submission entry, zeroed. Callers queue at most RING_ENTRIES
+    // between submit() calls.
+    io_uring_sqe* next() {
+        unsigned tail = *sq_tail_ + queued_;
+        unsigned index = tail & *sq_mask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[index] = index;
+        queued_++;
+        return sqe;
+    }
+
+    // Submit everything queued and wait until it has all completed. Returns
+    // false if the kernel rejected the submission.
+    bool submit() {
+        unsigned expected = queued_;
+        __atomic_store_n(sq_tail_, *sq_tail_ + queued_, __ATOMIC_RELEASE);
+        queued_ = 0;
+
+        // Completions are reaped after every submit(), so the queue starts
+        // empty and `expected` entries in it means everything is done
+        unsigned to_submit = expected;
+        while (to_submit > 0 || ready() < expected) {
+            long submitted = syscall(SYS_io_uring_enter, fd_, to_submit, expected,
+                                     IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (submitted < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            if (submitted == 0 && to_submit > 0) return false;
+            to_submit -= static_cast<unsigned>(submitted);
+        }
+        return true;
+    }
+
+    // Hand every available completion to fn(user_data, res)
+    template <typename Fn>
+    void reap(Fn&& fn) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+            fn(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+
+private:
+    unsigned ready() const {
+        return __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE) - *cq_head_;
+    }
+
+    bool map(const io_uring_params& params) {
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+        sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) return false;
+        cq_ring_ = single ? sq_ring_
+                          : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) return false;
+
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return false;
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        auto* sq = static_cast<char*>(sq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        auto* cq = static_cast<char*>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    int fd_ = -1;
+    void* sq_ring_ = MAP_FAILED;
+    void* cq_ring_ = MAP_FAILED;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    size_t sqes_size_ = 0;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    io_uring_sqe* sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned queued_ = 0;
+};
+
+// Close what a failed round left open
+void close_all(const int* fds, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (fds[i] >= 0) close(fds[i]);
+    }
+}
+
+} // namespace
+
+bool uring_read_files(std::vector<FileRead>& files) {
+    if (!g_available.load(std::memory_order_relaxed)) return false;
+    profiler::Phase phase("uring_reads");
+
+    Ring ring;
+    if (!ring.ok()) {
+        g_available.store(false, std::memory_order_relaxed);
+        return false;
+    }
+
+    size_t limit = 0;
+    for (const auto& file : files) limit = std::max(limit, file.limit);
+    std::vector<char> buffers(RING_FILES * limit);
+    int fds[RING_FILES];
+
+    for (size_t first = 0; first < files.size(); first += RING_FILES) {
+        size_t count = std::min<size_t>(RING_FILES, files.size() - first);
+
+        // Round one: every open
+        for (size_t i = 0; i < count; i++) {
+            io_uring_sqe* sqe = ring.next();
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<uintptr_t>(files[first + i].path.c_str());
+            sqe->open_flags = O_RDONLY | O_CLOEXEC;
+            sqe->user_data = i;
+            fds[i] = -1;
+        }
+        bool opened = ring.submit();
+        ring.reap([&](uint64_t i, int32_t res) {
+            fds[i] = res;
+            if (res >= 0) profiler::count(profiler::FILES_OPENED);
+        });
+        if (!opened) {
+            close_all(fds, count);
+            return false;
+        }
+
+        // Round two: a read of each opened file, hard-linked to its close so
+        // the descriptor is released whatever the read returns
+        for (size_t i = 0; i < count; i++) {
+            if (fds[i] < 0) continue;
+            io_uring_sqe* read_sqe = ring.next();
+            read_sqe->opcode = IORING_OP_READ;
+            read_sqe->fd = fds[i];
+            read_sqe->addr = reinterpret_cast<uintptr_t>(&buffers[i * limit]);
+            read_sqe->len = static_cast<uint32_t>(files[first + i].limit);
+            read_sqe->off = 0;
+            read_sqe->flags = IOSQE_IO_HARDLINK;
+            read_sqe->user_data = i;
+
+            io_uring_sqe* close_sqe = ring.next();
+            close_sqe->opcode = IORING_OP_CLOSE;
+            close_sqe->fd = fds[i];
+            close_sqe->user_data = CLOSE_TAG | i;
+        }
+        bool read_all = ring.submit();
+        ring.reap([&](uint64_t user_data, int32_t res) {
+            if (user_data & CLOSE_TAG) {
+                fds[user_data & ~CLOSE_TAG] = -1;
+                return;
+            }
+            if (res < 0) return;
+            FileRead& file = files[first + user_data];
+            file.data.assign(&buffers[user_data * limit], static_cast<size_t>(res));
+            file.ok = true;
+            profiler::count(profiler::BYTES_READ, static_cast<uint64_t>(res));
+        });
+        if (!read_all) {
+            close_all(fds, count);
+            return false;
+        }
+    }
+    return true;
+}
+
+#else
+
+bool uring_read_files(std::vector<FileRead>&) {
+    return false;
+}
+
+#endif
+
+} // namespace platform
+} // namespace zohd
+
+#endif // PLATFORM_LINUX
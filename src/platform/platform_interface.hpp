@@ -1,20 +1,214 @@
 #pragma once
 
 #include "../core/port_info.hpp"
+#include <array>
 #include <vector>
 #include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
 
 namespace zohd {
 namespace platform {
 
-// Platform-specific port checking
+// Where listener enumeration reads the kernel socket table from
+enum class SocketBackend {
+    AUTO,     // Netlink when available, procfs otherwise
+    NETLINK,  // NETLINK_SOCK_DIAG only (error if unavailable)
+    PROCFS    // /proc/net text tables only
+};
+
+// Socket families zohd enumerates
+enum class Protocol : uint8_t {
+    TCP,      // Listening TCP sockets
+    UDP,      // Bound UDP sockets
+    UDPLITE,  // Bound UDP-Lite sockets
+    UNIX      // Listening or bound Unix-domain sockets (no port)
+};
+
+constexpr uint32_t protocol_bit(Protocol protocol) {
+    return 1U << static_cast<uint8_t>(protocol);
+}
+
+// Protocols that occupy a port number
+constexpr uint32_t PORT_PROTOCOLS =
+    protocol_bit(Protocol::TCP) | protocol_bit(Protocol::UDP) | protocol_bit(Protocol::UDPLITE);
+constexpr uint32_t ALL_PROTOCOLS = PORT_PROTOCOLS | protocol_bit(Protocol::UNIX);
+
+// "tcp", "udp", "udplite", "unix"
+const char* protocol_name(Protocol protocol);
+
+// ProcessInfo fields to fill in; anything not requested is left empty
+enum ProcessField : uint32_t {
+    PROCESS_NAME = 1U << 0,
+    PROCESS_COMMAND_LINE = 1U << 1,
+    PROCESS_START_TIME = 1U << 2,
+    PROCESS_USER = 1U << 3,
+    PROCESS_ALL = PROCESS_NAME | PROCESS_COMMAND_LINE | PROCESS_START_TIME | PROCESS_USER
+};
+
+// Runtime switches for the platform layer, set once by the CLI
+struct PlatformOptions {
+    SocketBackend backend = SocketBackend::AUTO;
+    unsigned jobs = 1;                        // Threads for the /proc fd walk (0 = one per core)
+    bool numeric_users = false;               // Report uids, skip NSS lookups
+    uint32_t process_fields = PROCESS_ALL;    // Fields get_tcp_connections() resolves
+    uint32_t protocols = PORT_PROTOCOLS;      // protocol_bit() mask to enumerate
+    bool all_netns = false;                   // Every network namespace, not just ours
+    std::string proc_root = "/proc";          // procfs to read; anything else implies PROCFS
+    bool pid_cache = true;                    // Reuse process metadata across runs
+    bool io_uring = false;                    // Batch per-process /proc reads through io_uring
+};
+
+void set_options(const PlatformOptions& options);
+const PlatformOptions& get_options();
+
+// One listening (TCP, Unix) or bound (UDP) socket as reported by the
+// kernel, without process info
+struct SocketEntry {
+    Protocol protocol = Protocol::TCP;
+    uint16_t port = 0;  // 0 for Unix sockets
+    bool ipv6 = false;
+    uint32_t uid = 0;
+    unsigned long inode = 0;
+    std::string path;   // Unix sockets only; abstract names start with '@'
+    uint64_t netns = 0; // Network namespace inode (only set with all_netns)
+    bool other_netns = false;  // Read from another namespace; never binds locally
+
+    // Local address as the kernel's 32-bit words (network byte order in
+    // memory); IPv4 uses word 0. All zero for the wildcard address.
+    std::array<uint32_t, 4> address{};
+
+    // Queue depths as in /proc/net/<proto>. For TCP listeners rx_queue is
+    // the accept queue length; for UDP both are bytes buffered.
+    uint32_t rx_queue = 0;
+    uint32_t tx_queue = 0;
+
+    // TCP listeners: accept queue limit (the listen() backlog, capped at
+    // net.core.somaxconn). -1 if unknown; only netlink reports it.
+    int32_t backlog = -1;
+};
+
+// TCP states, numbered as the kernel reports them
+enum class TcpState : uint8_t {
+    ESTABLISHED = 1,
+    SYN_SENT,
+    SYN_RECV,
+    FIN_WAIT1,
+    FIN_WAIT2,
+    TIME_WAIT,
+    CLOSE,
+    CLOSE_WAIT,
+    LAST_ACK,
+    LISTEN,
+    CLOSING
+};
+constexpr size_t TCP_STATE_COUNT = 12;  // Highest state + 1
+
+// "ESTAB", "TIME-WAIT", ... as ss(8) prints them
+const char* tcp_state_name(TcpState state);
+
+// One TCP socket in any state, as passed to for_each_tcp_connection()
+struct TcpConnection {
+    TcpState state = TcpState::CLOSE;
+    bool ipv6 = false;
+    uint16_t local_port = 0;
+    uint16_t remote_port = 0;
+    std::array<uint32_t, 4> remote_address{};  // Layout as SocketEntry::address
+    uint32_t rx_queue = 0;
+    uint32_t tx_queue = 0;
+    unsigned long inode = 0;  // 0 for TIME_WAIT and pending requests
+};
+
+// Local ports the kernel picks from for connect() and bind() to port 0
+// (net.ipv4.ip_local_port_range), minus net.ipv4.ip_local_reserved_ports
+struct EphemeralRange {
+    uint16_t first = 32768;
+    uint16_t last = 60999;
+    std::vector<std::pair<uint16_t, uint16_t>> reserved;  // Inclusive ranges
+
+    bool is_reserved(uint16_t port) const {
+        for (const auto& range : reserved) {
+            if (port >= range.first && port <= range.second) return true;
+        }
+        return false;
+    }
+
+    // Port the kernel may assign on its own
+    bool contains(uint16_t port) const {
+        return port >= first && port <= last && !is_reserved(port);
+    }
+
+    // Number of ports contains() accepts
+    uint32_t usable() const {
+        uint32_t count = last >= first ? static_cast<uint32_t>(last - first) + 1 : 0;
+        for (uint32_t port = first; port <= last; port++) {
+            if (is_reserved(static_cast<uint16_t>(port))) count--;
+        }
+        return count;
+    }
+};
+
+// The range of our network namespace; the kernel defaults if unreadable
+EphemeralRange get_ephemeral_range();
+
+// "127.0.0.1", "::" and the like for a SocketEntry::address
+std::string address_string(const std::array<uint32_t, 4>& address, bool ipv6);
+
+// Rewrite an IPv4-mapped IPv6 address (::ffff:a.b.c.d) as plain IPv4 in
+// word 0. Returns false, leaving `address` alone, for any other address.
+bool unmap_ipv4(std::array<uint32_t, 4>& address);
+
+// Get sockets of the protocols in the `protocols` mask, optionally only
+// those bound to `port` (0 = all; Unix sockets are skipped when port != 0).
+// With all_netns, every distinct network namespace is read once.
+std::vector<SocketEntry> get_sockets(uint32_t protocols, uint16_t port = 0);
+
+// Whether get_sockets() with a port is a sock_diag query the kernel
+// filters by that port. False with procfs (chosen, or fallen back to), a
+// substitute proc_root or all_netns, where every call re-reads whole
+// tables and a per-port query costs as much as a full snapshot.
+bool port_queries_filtered();
+
+// Whether get_sockets() fills SocketEntry::backlog for the caller's
+// namespace, i.e. reads it through sock_diag. In auto mode, settles up
+// front (with one TCP dump) whether the backend will fall back to procfs.
+bool backlogs_reported();
+
+// Owning PID of each socket inode, found with one shared walk over the
+// process table. Inodes without a visible owner are absent from the map.
+std::unordered_map<unsigned long, uint32_t> find_socket_owners(
+    const std::vector<unsigned long>& inodes);
+
+// Platform-specific port checking. Answered from the per-invocation
+// socket snapshot, so repeated calls cost a bit test each.
 bool is_port_in_use(uint16_t port);
 
-// Get all TCP connections with process info
+// Status and owner of each port in `ports`, in order, from the same
+// snapshot. All owners are resolved with one shared /proc walk.
+std::vector<PortInfo> check_ports(const std::vector<uint16_t>& ports);
+
+// Processes to look up in get_process_sockets() (socket_table.hpp); unset
+// fields match any
+struct ProcessSelector {
+    uint32_t pid = 0;
+    std::string name;   // Process name as get_process_info() reports it
+    std::string user;   // User name or numeric uid
+};
+
+// Call fn for every TCP socket of our network namespace, IPv4 and IPv6:
+// all listeners first, then every other state. Owners are not resolved,
+// and buffers are reused across calls, so nothing is allocated per socket.
+void for_each_tcp_connection(const std::function<void(const TcpConnection&)>& fn);
+
+// Get every port-bound socket of the selected protocols with process info
+// (from the same snapshot)
 std::vector<PortInfo> get_tcp_connections();
 
-// Get process info by PID
-ProcessInfo get_process_info(uint32_t pid);
+// Get process info by PID, reading only what `fields` asks for
+ProcessInfo get_process_info(uint32_t pid, uint32_t fields = PROCESS_ALL);
 
 // Kill process (graceful)
 bool terminate_process(uint32_t pid);
@@ -22,11 +216,39 @@ bool terminate_process(uint32_t pid);
 // Kill process (force)
 bool force_kill_process(uint32_t pid);
 
+// Outcome of stop_processes() for one PID
+struct StopResult {
+    uint32_t pid = 0;
+    bool signalled = false;   // SIGTERM was delivered
+    bool exited = false;      // Gone before the deadline
+    bool escalated = false;   // Survived the timeout and was sent SIGKILL
+    double seconds = 0;       // From SIGTERM until exit
+};
+
+// SIGTERM every process and wait for all of them at once, for up to
+// `timeout` seconds. Each is held by pidfd where the kernel supports it,
+// and its start time is compared with the one in `processes` (if set)
+// once the pidfd is open, so a PID recycled since the scan is never
+// signalled; its original process counts as exited. With `escalate`,
+// survivors are sent SIGKILL and given one more second.
+std::vector<StopResult> stop_processes(const std::vector<ProcessInfo>& processes, double timeout,
+                                       bool escalate);
+
 // Get current username
 std::string get_current_user();
 
 // Check if process is alive
 bool is_process_alive(uint32_t pid);
 
+// Exit notification for one process: a pidfd, which turns readable once
+// that process (not just its PID) exits. -1 if the kernel has no pidfds
+// (before 5.3) or the process is already gone.
+int open_process_handle(uint32_t pid);
+void close_process_handle(int handle);
+
+// Positions in `handles` (-1 entries skipped) whose process has exited,
+// from one non-blocking poll()
+std::vector<size_t> exited_process_handles(const std::vector<int>& handles);
+
 } // namespace platform
 } // namespace zohd
@@ -0,0 +1,206 @@
+#include "proc_net_parser.hpp"
+#include "../core/profiler.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace zohd {
+namespace platform {
+
+namespace {
+
+// 0-15 for hex digits, 0xFF otherwise
+struct HexTable {
+    uint8_t value[256];
+
+    constexpr HexTable() : value{} {
+        for (int i = 0; i < 256; i++) value[i] = 0xFF;
+        for (int i = 0; i < 10; i++) value['0' + i] = static_cast<uint8_t>(i);
+        for (int i = 0; i < 6; i++) {
+            value['A' + i] = static_cast<uint8_t>(10 + i);
+            value['a' + i] = static_cast<uint8_t>(10 + i);
+        }
+    }
+};
+
+constexpr HexTable HEX;
+
+// Cursor over one line. Every helper returns false on malformed input.
+struct Cursor {
+    const char* p;
+    const char* end;
+
+    void skip_spaces() {
+        while (p < end && *p == ' ') p++;
+    }
+
+    bool expect(char c) {
+        if (p >= end || *p != c) return false;
+        p++;
+        return true;
+    }
+
+    // Exactly `digits` hex characters
+    template <typename T>
+    bool hex(size_t digits, T& out) {
+        if (static_cast<size_t>(end - p) < digits) return false;
+        T value = 0;
+        for (size_t i = 0; i < digits; i++) {
+            uint8_t v = HEX.value[static_cast<uint8_t>(p[i])];
+            if (v == 0xFF) return false;
+            value = static_cast<T>((value << 4) | v);
+        }
+        p += digits;
+        out = value;
+        return true;
+    }
+
+    // Unsigned decimal, at least one digit
+    template <typename T>
+    bool decimal(T& out) {
+        if (p >= end || *p < '0' || *p > '9') return false;
+        T value = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value = static_cast<T>(value * 10 + static_cast<T>(*p - '0'));
+            p++;
+        }
+        out = value;
+        return true;
+    }
+
+    bool skip_token() {
+        if (p >= end || *p == ' ') return false;
+        while (p < end && *p != ' ') p++;
+        return true;
+    }
+
+    // "ADDR:PORT" where ADDR is 8 (IPv4) or 32 (IPv6) hex digits
+    bool address(std::array<uint32_t, 4>& addr, uint16_t& port) {
+        const char* colon = p;
+        while (colon < end && *colon != ':') colon++;
+
+        size_t words = static_cast<size_t>(colon - p) / 8;
+        if ((words != 1 && words != 4) || static_cast<size_t>(colon - p) != words * 8) return false;
+
+        for (size_t i = 0; i < words; i++) {
+            uint32_t word;
+            if (!hex(8, word)) return false;
+            // The kernel prints each word with %08X of its in-memory value,
+            // so storing the host value restores the network byte layout
+            addr[i] = word;
+        }
+        for (size_t i = words; i < 4; i++) addr[i] = 0;
+
+        return expect(':') && hex(4, port);
+    }
+};
+
+} // namespace
+
+bool ProcNetParser::load(const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    profiler::count(profiler::FILES_OPENED);
+
+    if (buffer_.empty()) buffer_.resize(64 * 1024);
+    size_ = 0;
+
+    while (true) {
+        if (size_ == buffer_.size()) buffer_.resize(buffer_.size() * 2);
+
+        ssize_t n = read(fd, buffer_.data() + size_, buffer_.size() - size_);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (n == 0) break;
+        size_ += static_cast<size_t>(n);
+    }
+
+    close(fd);
+    profiler::count(profiler::BYTES_READ, size_);
+    return true;
+}
+
+ProcNetParser::RowResult ProcNetParser::parse_row(std::string_view line, uint32_t state_mask,
+                                                  ProcNetRow& row) {
+    // sl local_address rem_address st tx_queue:rx_queue tr:tm->when retrnsmt uid timeout inode
+    Cursor c{line.data(), line.data() + line.size()};
+
+    c.skip_spaces();
+    uint32_t slot;
+    if (!c.decimal(slot) || !c.expect(':')) return RowResult::MALFORMED;
+
+    // The state column sits after the two address columns; find it first so
+    // rows outside the mask cost only a scan to the third space-separated field
+    const char* addresses = c.p;
+    c.skip_spaces();
+    if (!c.skip_token()) return RowResult::MALFORMED;
+    c.skip_spaces();
+    if (!c.skip_token()) return RowResult::MALFORMED;
+    c.skip_spaces();
+
+    uint8_t state;
+    if (!c.hex(2, state)) return RowResult::MALFORMED;
+    if (state >= 32 || (state_mask & state_bit(state)) == 0) return RowResult::FILTERED;
+    row.state = state;
+
+    const char* after_state = c.p;
+    c.p = addresses;
+    c.skip_spaces();
+    if (!c.address(row.local_addr, row.local_port)) return RowResult::MALFORMED;
+    c.skip_spaces();
+    if (!c.address(row.remote_addr, row.remote_port)) return RowResult::MALFORMED;
+    c.p = after_state;
+
+    c.skip_spaces();
+    if (!c.hex(8, row.tx_queue) || !c.expect(':') || !c.hex(8, row.rx_queue)) {
+        return RowResult::MALFORMED;
+    }
+
+    // tr:tm->when, retrnsmt
+    c.skip_spaces();
+    if (!c.skip_token()) return RowResult::MALFORMED;
+    c.skip_spaces();
+    if (!c.skip_token()) return RowResult::MALFORMED;
+
+    c.skip_spaces();
+    if (!c.decimal(row.uid)) return RowResult::MALFORMED;
+
+    // timeout (may be negative)
+    c.skip_spaces();
+    if (!c.skip_token()) return RowResult::MALFORMED;
+
+    c.skip_spaces();
+    if (!c.decimal(row.inode)) return RowResult::MALFORMED;
+
+    return RowResult::OK;
+}
+
+bool ProcNetParser::parse_unix_row(std::string_view line, ProcNetUnixRow& row) {
+    // Num: RefCount Protocol Flags Type St Inode [Path]
+    Cursor c{line.data(), line.data() + line.size()};
+
+    c.skip_spaces();
+    if (!c.skip_token()) return false;  // Kernel address with trailing ':'
+    c.skip_spaces();
+    if (!c.skip_token()) return false;  // RefCount
+    c.skip_spaces();
+    if (!c.skip_token()) return false;  // Protocol
+
+    c.skip_spaces();
+    if (!c.hex(8, row.flags)) return false;
+    c.skip_spaces();
+    if (!c.hex(4, row.type)) return false;
+    c.skip_spaces();
+    if (!c.hex(2, row.state)) return false;
+    c.skip_spaces();
+    if (!c.decimal(row.inode)) return false;
+
+    c.skip_spaces();
+    row.path = std::string_view(c.p, static_cast<size_t>(c.end - c.p));
+    return true;
+}
+
+} // namespace platform
+} // namespace zohd
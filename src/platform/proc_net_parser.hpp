@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace zohd {
+namespace platform {
+
+// Kernel socket states as printed in the "st" column
+enum ProcNetState : uint8_t {
+    TCP_STATE_ESTABLISHED = 0x01,
+    TCP_STATE_TIME_WAIT = 0x06,
+    TCP_STATE_CLOSE = 0x07,
+    TCP_STATE_CLOSE_WAIT = 0x08,
+    TCP_STATE_LISTEN = 0x0A
+};
+
+constexpr uint32_t state_bit(uint8_t state) { return 1U << state; }
+constexpr uint32_t ALL_STATES = 0xFFFFFFFFU;
+
+// One decoded row of /proc/net/{tcp,tcp6,udp,udp6,...}
+struct ProcNetRow {
+    // Addresses are the kernel's 32-bit words, i.e. network byte order in memory.
+    // IPv4 rows only use word 0.
+    std::array<uint32_t, 4> local_addr{};
+    std::array<uint32_t, 4> remote_addr{};
+    uint16_t local_port = 0;
+    uint16_t remote_port = 0;
+    uint8_t state = 0;
+    uint32_t tx_queue = 0;
+    uint32_t rx_queue = 0;
+    uint32_t uid = 0;
+    unsigned long inode = 0;
+};
+
+// One decoded row of /proc/net/unix
+struct ProcNetUnixRow {
+    uint32_t flags = 0;     // __SO_ACCEPTCON (0x10000) marks listening sockets
+    uint16_t type = 0;      // SOCK_STREAM, SOCK_DGRAM, SOCK_SEQPACKET
+    uint8_t state = 0;      // SS_UNCONNECTED (1), SS_CONNECTED (3), ...
+    unsigned long inode = 0;
+    std::string_view path;  // Empty if unbound; abstract names start with '@'
+};
+
+// Reusable, allocation-free parser for the /proc/net socket tables.
+// The file is read() into one growable buffer and walked with
+// string_views; fixed-width hex fields are decoded by hand.
+class ProcNetParser {
+public:
+    enum class RowResult {
+        OK,        // Row decoded
+        FILTERED,  // State not in the mask; only the state column was decoded
+        MALFORMED  // Not a socket row (header, truncated line)
+    };
+
+    // Read the whole file into the internal buffer, reusing its capacity.
+    // Returns false if the file cannot be opened.
+    bool load(const char* path);
+
+    // Call fn(const ProcNetRow&) for every row whose state is in state_mask
+    template <typename Fn>
+    void for_each(uint32_t state_mask, Fn&& fn) const {
+        std::string_view text(buffer_.data(), size_);
+
+        // First line is the column header
+        size_t pos = text.find('\n');
+        if (pos == std::string_view::npos) return;
+        pos++;
+
+        ProcNetRow row;
+        while (pos < text.size()) {
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos) end = text.size();
+
+            if (parse_row(text.substr(pos, end - pos), state_mask, row) == RowResult::OK) {
+                fn(row);
+            }
+            pos = end + 1;
+        }
+    }
+
+    // Call fn(const ProcNetUnixRow&) for every row of a loaded /proc/net/unix.
+    // Paths point into the parser's buffer and are valid until the next load().
+    template <typename Fn>
+    void for_each_unix(Fn&& fn) const {
+        std::string_view text(buffer_.data(), size_);
+
+        size_t pos = text.find('\n');
+        if (pos == std::string_view::npos) return;
+        pos++;
+
+        ProcNetUnixRow row;
+        while (pos < text.size()) {
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos) end = text.size();
+
+            if (parse_unix_row(text.substr(pos, end - pos), row)) fn(row);
+            pos = end + 1;
+        }
+    }
+
+    // Decode a single line (exposed for tests and benchmarks)
+    static RowResult parse_row(std::string_view line, uint32_t state_mask, ProcNetRow& row);
+    static bool parse_unix_row(std::string_view line, ProcNetUnixRow& row);
+
+private:
+    std::vector<char> buffer_;
+    size_t size_ = 0;
+};
+
+} // namespace platform
+} // namespace zohd
@@ -0,0 +1,110 @@
+#include "socket_snapshot.hpp"
+#include "../core/profiler.hpp"
+#include <algorithm>
+#include <optional>
+#ifdef PLATFORM_WINDOWS
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#endif
+
+namespace zohd {
+namespace platform {
+
+const char* protocol_name(Protocol protocol) {
+    switch (protocol) {
+        case Protocol::TCP: return "tcp";
+        case Protocol::UDP: return "udp";
+        case Protocol::UDPLITE: return "udplite";
+        case Protocol::UNIX: return "unix";
+    }
+    return "?";
+}
+
+const char* tcp_state_name(TcpState state) {
+    switch (state) {
+        case TcpState::ESTABLISHED: return "ESTAB";
+        case TcpState::SYN_SENT: return "SYN-SENT";
+        case TcpState::SYN_RECV: return "SYN-RECV";
+        case TcpState::FIN_WAIT1: return "FIN-WAIT-1";
+        case TcpState::FIN_WAIT2: return "FIN-WAIT-2";
+        case TcpState::TIME_WAIT: return "TIME-WAIT";
+        case TcpState::CLOSE: return "CLOSE";
+        case TcpState::CLOSE_WAIT: return "CLOSE-WAIT";
+        case TcpState::LAST_ACK: return "LAST-ACK";
+        case TcpState::LISTEN: return "LISTEN";
+        case TcpState::CLOSING: return "CLOSING";
+    }
+    return "?";
+}
+
+std::string address_string(const std::array<uint32_t, 4>& address, bool ipv6) {
+    char text[INET6_ADDRSTRLEN];
+    if (!inet_ntop(ipv6 ? AF_INET6 : AF_INET, address.data(), text, sizeof(text))) return "?";
+    return text;
+}
+
+bool unmap_ipv4(std::array<uint32_t, 4>& address) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(address.data());
+    if (address[0] != 0 || address[1] != 0 || bytes[8] != 0 || bytes[9] != 0 ||
+        bytes[10] != 0xFF || bytes[11] != 0xFF) {
+        return false;
+    }
+    address = {address[3], 0, 0, 0};
+    return true;
+}
+
+SocketSnapshot::SocketSnapshot(std::vector<SocketEntry> entries)
+    : entries_(std::move(entries)) {
+    // Stable so that per-port rows keep the enumeration order; rows from
+    // other namespaces follow the caller's own for each port
+    std::stable_sort(entries_.begin(), entries_.end(),
+                     [](const SocketEntry& a, const SocketEntry& b) {
+                         return a.port != b.port ? a.port < b.port : a.other_netns < b.other_netns;
+                     });
+
+    for (const auto& entry : entries_) {
+        if (entry.protocol == Protocol::UNIX || entry.other_netns) continue;
+
+        uint64_t bit = uint64_t{1} << (entry.port & 63);
+        any_bits_[entry.port >> 6] |= bit;
+        protocol_bits_[static_cast<uint8_t>(entry.protocol)][entry.port >> 6] |= bit;
+    }
+}
+
+SocketSnapshot SocketSnapshot::capture() {
+    return capture(get_options().protocols);
+}
+
+SocketSnapshot SocketSnapshot::capture(uint32_t protocols) {
+    profiler::Phase phase("snapshot");
+    return SocketSnapshot(get_sockets(protocols));
+}
+
+SocketSnapshot::Range SocketSnapshot::find(uint16_t port) const {
+    if (!is_listening(port)) return {};
+
+    const SocketEntry* first = entries_.data();
+    const SocketEntry* last = first + entries_.size();
+
+    Range result;
+    result.first = std::lower_bound(first, last, port,
+        [](const SocketEntry& entry, uint16_t p) { return entry.port < p; });
+    result.last = std::upper_bound(result.first, last, port,
+        [](uint16_t p, const SocketEntry& entry) { return p < entry.port || entry.other_netns; });
+    return result;
+}
+
+static std::optional<SocketSnapshot> g_snapshot;
+
+const SocketSnapshot& current_snapshot() {
+    if (!g_snapshot) g_snapshot = SocketSnapshot::capture();
+    return *g_snapshot;
+}
+
+void refresh_current_snapshot() {
+    g_snapshot.reset();
+}
+
+} // namespace platform
+} // namespace zohd
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "platform_interface.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace zohd {
+namespace platform {
+
+// Immutable view of the socket tables of every selected protocol, captured
+// in one pass. Port membership is a bit test; per-port rows come from a
+// port-sorted table. Both lookups cover the caller's own network namespace
+// only: a port bound in a container's namespace (--all-netns) is still
+// free here, and its owner is nothing check, suggest or kill should act on.
+class SocketSnapshot {
+public:
+    // Contiguous run of entries bound to one port
+    struct Range {
+        const SocketEntry* first = nullptr;
+        const SocketEntry* last = nullptr;
+
+        const SocketEntry* begin() const { return first; }
+        const SocketEntry* end() const { return last; }
+        bool empty() const { return first == last; }
+    };
+
+    SocketSnapshot() = default;
+    explicit SocketSnapshot(std::vector<SocketEntry> entries);
+
+    // Read the socket tables of the protocols in the mask
+    // (default: the --proto selection)
+    static SocketSnapshot capture();
+    static SocketSnapshot capture(uint32_t protocols);
+
+    // Port held by any protocol in the snapshot
+    bool is_listening(uint16_t port) const {
+        return (any_bits_[port >> 6] >> (port & 63)) & 1;
+    }
+
+    // Port held by one protocol
+    bool is_bound(Protocol protocol, uint16_t port) const {
+        const auto& bits = protocol_bits_[static_cast<uint8_t>(protocol)];
+        return (bits[port >> 6] >> (port & 63)) & 1;
+    }
+
+    // All rows for `port`, in protocol order, IPv4 before IPv6
+    Range find(uint16_t port) const;
+
+    // Every row, other namespaces included, sorted by port (Unix sockets,
+    // port 0, first)
+    const std::vector<SocketEntry>& entries() const { return entries_; }
+
+private:
+    using Bitmap = std::array<uint64_t, 65536 / 64>;
+
+    Bitmap any_bits_{};
+    std::array<Bitmap, 3> protocol_bits_{};  // TCP, UDP, UDP-Lite
+    std::vector<SocketEntry> entries_;
+};
+
+// Snapshot shared by every query in this invocation, captured on first use
+const SocketSnapshot& current_snapshot();
+
+// Drop the shared snapshot; the next query captures a fresh one
+void refresh_current_snapshot();
+
+} // namespace platform
+} // namespace zohd
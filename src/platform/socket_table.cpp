@@ -0,0 +1,165 @@
+#include "socket_table.hpp"
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+namespace zohd {
+namespace platform {
+
+std::string_view StringArena::intern(std::string_view text) {
+    if (text.empty()) return {};
+
+    auto it = strings_.find(text);
+    if (it != strings_.end()) return *it;
+
+    char* copy;
+    if (text.size() > BLOCK_SIZE / 4) {
+        // Large strings get a block of their own, so the current one keeps filling
+        blocks_.push_back(std::make_unique<char[]>(text.size()));
+        copy = blocks_.back().get();
+    } else {
+        if (!current_ || BLOCK_SIZE - block_used_ < text.size()) {
+            blocks_.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+            current_ = blocks_.back().get();
+            block_used_ = 0;
+        }
+        copy = current_ + block_used_;
+        block_used_ += text.size();
+    }
+
+    std::memcpy(copy, text.data(), text.size());
+    return *strings_.insert(std::string_view(copy, text.size())).first;
+}
+
+ProcessInfo ProcessRecord::to_process_info() const {
+    ProcessInfo info;
+    info.pid = pid;
+    info.start_time = start_time;
+    info.name = std::string(name);
+    info.command_line = std::string(command_line);
+    info.user = std::string(user);
+    return info;
+}
+
+void SocketTable::reserve(size_t rows) {
+    port_.reserve(rows);
+    protocol_.reserve(rows);
+    ipv6_.reserve(rows);
+    uid_.reserve(rows);
+    inode_.reserve(rows);
+    netns_.reserve(rows);
+    address_.reserve(rows);
+    rx_queue_.reserve(rows);
+    tx_queue_.reserve(rows);
+    path_.reserve(rows);
+    container_.reserve(rows);
+    process_.reserve(rows);
+}
+
+uint32_t SocketTable::find_process(uint32_t pid) const {
+    auto it = process_index_.find(pid);
+    return it == process_index_.end() ? NO_PROCESS : it->second;
+}
+
+uint32_t SocketTable::add_process(const ProcessInfo& info) {
+    uint32_t index = static_cast<uint32_t>(processes_.size());
+    auto [it, added] = process_index_.emplace(info.pid, index);
+    if (!added) return it->second;
+
+    ProcessRecord record;
+    record.pid = info.pid;
+    record.start_time = info.start_time;
+    record.name = strings_.intern(info.name);
+    record.command_line = strings_.intern(info.command_line);
+    record.user = strings_.intern(info.user);
+    processes_.push_back(record);
+    return index;
+}
+
+void SocketTable::add(const SocketEntry& entry, uint32_t process, std::string_view container) {
+    port_.push_back(entry.port);
+    protocol_.push_back(entry.protocol);
+    ipv6_.push_back(entry.ipv6 ? 1 : 0);
+    uid_.push_back(entry.uid);
+    inode_.push_back(entry.inode);
+    netns_.push_back(entry.netns);
+    address_.push_back(entry.address);
+    rx_queue_.push_back(entry.rx_queue);
+    tx_queue_.push_back(entry.tx_queue);
+    path_.push_back(entry.path.empty() ? std::string_view() : strings_.intern(entry.path));
+    container_.push_back(container.empty() ? std::string_view() : strings_.intern(container));
+    process_.push_back(process);
+}
+
+void SocketTable::add_holder(uint32_t process) {
+    size_t row = process_.size() - 1;
+    if (process_[row] == NO_PROCESS) {
+        process_[row] = process;
+    } else if (process != process_[row]) {
+        other_holders_[row].push_back(process);
+    }
+}
+
+size_t SocketTable::holder_count(size_t row) const {
+    if (process_[row] == NO_PROCESS) return 0;
+    auto it = other_holders_.find(row);
+    return 1 + (it == other_holders_.end() ? 0 : it->second.size());
+}
+
+const ProcessRecord& SocketTable::holder(size_t row, size_t i) const {
+    if (i == 0) return processes_[process_[row]];
+    return processes_[other_holders_.at(row)[i - 1]];
+}
+
+std::vector<SocketGroup> group_by_address(const SocketTable& table) {
+    auto key = [&table](size_t row) {
+        return std::make_tuple(table.port(row), table.protocol(row), table.ipv6(row),
+                               table.address(row), table.netns(row));
+    };
+
+    std::vector<size_t> rows;
+    for (size_t row = 0; row < table.size(); row++) {
+        if (table.protocol(row) != Protocol::UNIX) rows.push_back(row);
+    }
+    std::stable_sort(rows.begin(), rows.end(),
+                     [&key](size_t a, size_t b) { return key(a) < key(b); });
+
+    std::vector<SocketGroup> groups;
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (i == 0 || key(rows[i]) != key(rows[i - 1])) groups.emplace_back();
+        groups.back().push_back(rows[i]);
+    }
+    return groups;
+}
+
+std::vector<PortInfo> summarize_ports(const SocketTable& table, const std::vector<uint16_t>& ports) {
+    // Port -> first row with a known owner, or NO_ROW if none has one
+    constexpr size_t NO_ROW = SIZE_MAX;
+    std::unordered_map<uint16_t, size_t> owner_row;
+    for (size_t row = 0; row < table.size(); row++) {
+        if (table.protocol(row) == Protocol::UNIX) continue;
+
+        auto it = owner_row.emplace(table.port(row), NO_ROW).first;
+        if (it->second == NO_ROW && table.process(row)) it->second = row;
+    }
+
+    std::vector<PortInfo> result;
+    result.reserve(ports.size());
+    for (uint16_t port : ports) {
+        PortInfo info;
+        info.port = port;
+        info.status = PortStatus::FREE;
+
+        auto it = owner_row.find(port);
+        if (it != owner_row.end()) {
+            info.status = PortStatus::IN_USE;
+            if (it->second != NO_ROW) info.process = table.process(it->second)->to_process_info();
+        }
+
+        result.push_back(std::move(info));
+    }
+    return result;
+}
+
+} // namespace platform
+} // namespace zohd
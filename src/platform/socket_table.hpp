@@ -0,0 +1,143 @@
+#pragma once
+
+#include "platform_interface.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace zohd {
+namespace platform {
+
+// Append-only store of deduplicated strings. Views returned by intern()
+// stay valid as long as the arena does.
+class StringArena {
+public:
+    StringArena() = default;
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+    StringArena(StringArena&&) = default;
+    StringArena& operator=(StringArena&&) = default;
+
+    std::string_view intern(std::string_view text);
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* current_ = nullptr;  // Block small strings are appended to
+    size_t block_used_ = 0;
+    std::unordered_set<std::string_view> strings_;
+};
+
+// Owner of one or more rows of a SocketTable
+struct ProcessRecord {
+    uint32_t pid = 0;
+    uint64_t start_time = 0;
+    std::string_view name;
+    std::string_view command_line;
+    std::string_view user;
+
+    ProcessInfo to_process_info() const;
+};
+
+// Sockets and their owners, one column per field. Each process is stored
+// once and rows refer to it by index; all strings live in one arena.
+class SocketTable {
+public:
+    static constexpr uint32_t NO_PROCESS = UINT32_MAX;
+
+    void reserve(size_t rows);
+
+    // Index of the record for `pid`, or NO_PROCESS if it has none yet
+    uint32_t find_process(uint32_t pid) const;
+    uint32_t add_process(const ProcessInfo& info);
+
+    // Append a row owned by `process` (an index from add_process(), or NO_PROCESS)
+    void add(const SocketEntry& entry, uint32_t process, std::string_view container = {});
+
+    // Record another process holding the last added row's socket, e.g. a
+    // preforked worker that inherited its parent's listener
+    void add_holder(uint32_t process);
+
+    size_t size() const { return port_.size(); }
+    bool empty() const { return port_.empty(); }
+
+    uint16_t port(size_t row) const { return port_[row]; }
+    Protocol protocol(size_t row) const { return protocol_[row]; }
+    bool ipv6(size_t row) const { return ipv6_[row] != 0; }
+    uint32_t uid(size_t row) const { return uid_[row]; }
+    unsigned long inode(size_t row) const { return inode_[row]; }
+    uint64_t netns(size_t row) const { return netns_[row]; }
+    const std::array<uint32_t, 4>& address(size_t row) const { return address_[row]; }
+    uint32_t rx_queue(size_t row) const { return rx_queue_[row]; }
+    uint32_t tx_queue(size_t row) const { return tx_queue_[row]; }
+    std::string_view path(size_t row) const { return path_[row]; }
+    std::string_view container(size_t row) const { return container_[row]; }
+
+    // Owner of the row, nullptr if unknown
+    const ProcessRecord* process(size_t row) const {
+        return process_[row] == NO_PROCESS ? nullptr : &processes_[process_[row]];
+    }
+
+    // Every process holding the row's socket; holder(row, 0) is process(row)
+    size_t holder_count(size_t row) const;
+    const ProcessRecord& holder(size_t row, size_t i) const;
+
+    const std::vector<ProcessRecord>& processes() const { return processes_; }
+
+private:
+    std::vector<uint16_t> port_;
+    std::vector<Protocol> protocol_;
+    std::vector<uint8_t> ipv6_;
+    std::vector<uint32_t> uid_;
+    std::vector<unsigned long> inode_;
+    std::vector<uint64_t> netns_;
+    std::vector<std::array<uint32_t, 4>> address_;
+    std::vector<uint32_t> rx_queue_;
+    std::vector<uint32_t> tx_queue_;
+    std::vector<std::string_view> path_;        // Unix sockets only
+    std::vector<std::string_view> container_;   // Only set with all_netns
+    std::vector<uint32_t> process_;
+    std::unordered_map<size_t, std::vector<uint32_t>> other_holders_;  // Shared sockets only
+
+    std::vector<ProcessRecord> processes_;
+    std::unordered_map<uint32_t, uint32_t> process_index_;  // PID -> processes_ index
+    StringArena strings_;
+};
+
+// Rows of one protocol bound to the same address and port, e.g. the
+// listeners of an SO_REUSEPORT group, in table order
+using SocketGroup = std::vector<size_t>;
+
+// Port-bound rows of `table` grouped by protocol, address and port (and
+// network namespace), ordered by port
+std::vector<SocketGroup> group_by_address(const SocketTable& table);
+
+// Status and first known owner of each of `ports`, in order
+std::vector<PortInfo> summarize_ports(const SocketTable& table, const std::vector<uint16_t>& ports);
+
+// Every socket of the selected protocols with its owner, from the shared
+// snapshot. Each owning process is read once.
+SocketTable get_socket_table();
+
+// Sockets bound to any of `ports`, with every process holding each of them.
+// Unlike check_ports(), which stops at one owner per socket, this walks
+// all of /proc, since any process may have inherited a socket.
+SocketTable get_port_sockets(const std::vector<uint16_t>& ports);
+
+// Sockets bound to any of `ports` with one owner each, found the way
+// check_ports() finds them: owner hints first, then same-uid processes
+SocketTable get_port_owners(const std::vector<uint16_t>& ports);
+
+// Sockets held by the selected processes. Only their /proc/<pid>/fd
+// directories are read, then joined against the socket snapshot, so the
+// cost follows the targets' fd count rather than the host's.
+// Throws std::runtime_error for an unknown user name.
+SocketTable get_process_sockets(const ProcessSelector& selector);
+
+} // namespace platform
+} // namespace zohd
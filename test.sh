@@ -63,6 +63,18 @@ section() {
     echo "========================================"
 }
 
+# Fake procfs for --proc-root: sets FIXTURE to a new temp dir whose
+# net/<proto> tables hold only the header line
+PROC_NET_HEADER="  sl  local_address rem_address   st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode"
+make_fixture() {
+    FIXTURE=$(mktemp -d)
+    mkdir -p "$FIXTURE/net"
+    local table
+    for table in tcp tcp6 udp udp6 udplite udplite6; do
+        echo "$PROC_NET_HEADER" > "$FIXTURE/net/$table"
+    done
+}
+
 # Check if zohd is built
 if [ ! -f "build/zohd" ]; then
     echo -e "${RED}Error: build/zohd not found. Please run ./build.sh first${NC}"
@@ -188,7 +200,7 @@ if command -v python3 &> /dev/null; then
 
     # Test 6.1: Check port 8888 (should be IN USE)
     info "Checking port 8888 (should be IN USE)"
-    output=$($ZOHD check 8888)
+    output=$($ZOHD check 8888 || true)
     if echo "$output" | grep -q "IN USE"; then
         pass "Port 8888 correctly detected as IN USE"
     else
@@ -228,7 +240,7 @@ if command -v python3 &> /dev/null; then
     info "Testing kill command on port 8888"
     if $ZOHD kill 8888 --force > /dev/null 2>&1; then
         sleep 0.5
-        output=$($ZOHD check 8888)
+        output=$($ZOHD check 8888 || true)
         if echo "$output" | grep -q "FREE"; then
             pass "Port 8888 successfully freed"
         else
@@ -248,7 +260,7 @@ section "Test 7: Edge Cases"
 # Test 7.1: Check system ports
 info "Checking well-known ports"
 for port in 22 80 443; do
-    output=$($ZOHD check $port 2>&1)
+    output=$($ZOHD check $port 2>&1 || true)
     if echo "$output" | grep -q "Port $port"; then
         pass "Can check port $port"
     else
@@ -332,4 +344,847 @@ else
     fail "Accepts invalid subcommands"
 fi
 
+section "Test 11: Socket Backends"
+
+# Test 11.1: Both backends agree on the listener set
+info "Comparing netlink and procfs listener tables"
+procfs_ports=$($ZOHD --backend procfs list | awk '/^[0-9]/ {print $1}' | sort)
+auto_ports=$($ZOHD --backend auto list | awk '/^[0-9]/ {print $1}' | sort)
+if [ "$procfs_ports" = "$auto_ports" ]; then
+    pass "auto and procfs backends report the same listeners"
+else
+    fail "Backends disagree"
+    echo "procfs: $procfs_ports"
+    echo "auto:   $auto_ports"
+fi
+
+# Test 11.2: Invalid backend name
+info "Testing invalid backend name"
+if ! $ZOHD --backend bogus list > /dev/null 2>&1; then
+    pass "Rejects unknown backend"
+else
+    fail "Accepts unknown backend"
+fi
+
+section "Test 12: Watch Command"
+
+# Test 12.1: watch reports a server opening and closing
+if command -v python3 &> /dev/null; then
+    info "Watching while a server on port 8892 starts and stops"
+    $ZOHD watch --interval 0.2 --count 15 > watch-output.txt &
+    WATCH_PID=$!
+    sleep 0.5
+    python3 -m http.server 8892 > /dev/null 2>&1 &
+    SERVER_PID=$!
+    sleep 1
+    kill $SERVER_PID 2>/dev/null || true
+    wait $WATCH_PID 2>/dev/null || true
+
+    if grep -q '"event":"opened","proto":"tcp","port":8892' watch-output.txt; then
+        pass "Watch reported port 8892 opening"
+    else
+        fail "Watch missed port 8892 opening"
+    fi
+    if grep -q '"event":"closed","proto":"tcp","port":8892' watch-output.txt; then
+        pass "Watch reported port 8892 closing"
+    else
+        fail "Watch missed port 8892 closing"
+    fi
+    rm -f watch-output.txt
+
+    # Test 12.2: a child that inherits the listener is reported as its new owner
+    $ZOHD watch --interval 0.2 --count 15 > watch-output.txt &
+    WATCH_PID=$!
+    sleep 0.5
+    python3 -c "
+import os, socket, time
+s = socket.socket()
+s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+s.bind(('127.0.0.1', 8916))
+s.listen()
+if os.fork() == 0:
+    print(os.getpid(), flush=True)
+    time.sleep(3)
+    os._exit(0)
+time.sleep(0.6)
+" > watch-child.txt &
+    wait $WATCH_PID 2>/dev/null || true
+
+    child=$(cat watch-child.txt)
+    if grep '"event":"owner-changed","proto":"tcp","port":8916' watch-output.txt | grep -q "\"pid\":$child"; then
+        pass "Watch reported the inherited listener's new owner"
+    else
+        fail "Watch missed the owner change on port 8916"
+    fi
+    rm -f watch-output.txt watch-child.txt
+else
+    info "Python3 not found, skipping watch tests"
+fi
+
+section "Test 13: UDP Sockets"
+
+# Test 13.1: A bound UDP port is in use unless --proto excludes UDP
+if command -v python3 &> /dev/null; then
+    info "Binding UDP port 8893"
+    python3 -c "import socket, time; s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM); s.bind(('127.0.0.1', 8893)); time.sleep(30)" &
+    TEST_SERVERS+=($!)
+    sleep 0.5
+
+    if $ZOHD check 8893 | grep -q "IN USE"; then
+        pass "UDP port 8893 detected as IN USE"
+    else
+        fail "UDP port 8893 not detected"
+    fi
+
+    if $ZOHD --proto tcp check 8893 | grep -q "FREE"; then
+        pass "--proto tcp ignores UDP port 8893"
+    else
+        fail "--proto tcp still reports UDP port 8893"
+    fi
+
+    if $ZOHD list | grep -E "^8893 +udp" > /dev/null; then
+        pass "List shows the UDP protocol"
+    else
+        fail "List missing UDP row for 8893"
+    fi
+
+    # Test 13.2: A connected UDP client is not a bound service, on either backend
+    python3 -c "import socket, time; s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM); s.bind(('127.0.0.1', 8913)); s.connect(('127.0.0.1', 8893)); time.sleep(30)" &
+    TEST_SERVERS+=($!)
+    sleep 0.5
+    if $ZOHD check 8913 | grep -q "FREE" && $ZOHD --backend procfs check 8913 | grep -q "FREE"; then
+        pass "Connected UDP socket on 8913 not reported"
+    else
+        fail "Connected UDP socket on 8913 reported as a service"
+    fi
+else
+    info "Python3 not found, skipping UDP tests"
+fi
+
+section "Test 14: Network Namespaces"
+
+# Test 14.1: A listener in another namespace is only visible with --all-netns
+if command -v python3 &> /dev/null && unshare -n true 2>/dev/null; then
+    info "Starting a listener on port 8894 in a new network namespace"
+    unshare -n python3 -c "import socket, time; s = socket.socket(); s.bind(('127.0.0.1', 8894)); s.listen(); time.sleep(30)" &
+    TEST_SERVERS+=($!)
+    sleep 0.5
+
+    if $ZOHD check 8894 | grep -q "FREE"; then
+        pass "Port 8894 in another namespace is hidden by default"
+    else
+        fail "Port 8894 visible without --all-netns"
+    fi
+
+    if $ZOHD --all-netns list | grep -E "^8894 +tcp +[0-9]+" > /dev/null; then
+        pass "--all-netns lists port 8894 with its namespace"
+    else
+        fail "--all-netns missed port 8894"
+    fi
+
+    # Test 14.2: Listing other namespaces does not make their ports busy here
+    if $ZOHD --all-netns check 8894 | grep -q "FREE" && $ZOHD --all-netns kill 8894 --force > /dev/null 2>&1 &&
+       $ZOHD --all-netns list | grep -qE "^8894 +tcp"; then
+        pass "--all-netns check and kill leave port 8894 alone"
+    else
+        fail "--all-netns treated another namespace's port 8894 as local"
+    fi
+else
+    info "unshare -n not permitted, skipping namespace tests"
+fi
+
+section "Test 15: Batch Port Queries"
+
+# Test 15.1: Ranges expand and an all-free batch exits 0
+if output=$($ZOHD check 8896 8897-8899); then
+    if echo "$output" | grep -q "FREE: 8896-8899"; then
+        pass "Free batch exits 0 and folds ports into a range"
+    else
+        fail "Free batch summary wrong"
+        echo "Output: $output"
+    fi
+else
+    fail "Free batch returned non-zero"
+fi
+
+# Test 15.2: Reversed or out-of-range specs are rejected
+if ! $ZOHD check 9000-8000 > /dev/null 2>&1 && ! $ZOHD check 8000-70000 > /dev/null 2>&1; then
+    pass "Invalid ranges rejected"
+else
+    fail "Invalid ranges accepted"
+fi
+
+if command -v python3 &> /dev/null; then
+    python3 -m http.server 8895 > /dev/null 2>&1 &
+    TEST_SERVERS+=($!)
+    sleep 0.5
+
+    # Test 15.3: One busy port makes the batch exit 1
+    set +e
+    output=$($ZOHD check 8895-8899)
+    status=$?
+    set -e
+    if [ $status -eq 1 ] && echo "$output" | grep -q "1 of 5 ports in use"; then
+        pass "Busy batch exits 1 with summary"
+    else
+        fail "Busy batch: status $status"
+        echo "Output: $output"
+    fi
+
+    # Test 15.4: Batch kill frees the busy port
+    if $ZOHD kill 8895-8899 --force > /dev/null 2>&1; then
+        sleep 0.5
+        if $ZOHD check 8895 > /dev/null; then
+            pass "Batch kill freed port 8895"
+        else
+            info "Port 8895 might still be in TIME_WAIT state (normal)"
+        fi
+    else
+        fail "Batch kill failed"
+    fi
+fi
+
+section "Test 16: Output Formats"
+
+# Test 16.1: JSON Lines carry one object per port
+output=$($ZOHD --format jsonl check 9999)
+if [ "$output" = '{"port":9999,"status":"free"}' ]; then
+    pass "jsonl check output"
+else
+    fail "jsonl check output: $output"
+fi
+
+# Test 16.2: JSON and CSV list output parse
+if command -v python3 &> /dev/null; then
+    if $ZOHD --format json list --proto all | python3 -c "import json, sys; json.load(sys.stdin)"; then
+        pass "json list output parses"
+    else
+        fail "json list output does not parse"
+    fi
+    if $ZOHD --format csv list | python3 -c "import csv, sys; rows = list(csv.reader(sys.stdin)); assert all(len(r) == 17 for r in rows)"; then
+        pass "csv list output has 17 columns per row"
+    else
+        fail "csv list output malformed"
+    fi
+fi
+
+# Test 16.3: Binary output is a header plus whole 96-byte records
+size=$($ZOHD --format bin list | wc -c)
+if [ $(( (size - 16) % 96 )) -eq 0 ] && [ "$($ZOHD --format bin list | head -c 4)" = "ZOHD" ]; then
+    pass "bin output layout"
+else
+    fail "bin output size $size"
+fi
+
+section "Test 17: Fixture procfs"
+
+# Test 17.1: --proc-root reads tables and owners from a fake tree
+make_fixture
+mkdir -p "$FIXTURE/4242/fd"
+printf '   0: 0100007F:22B8 00000000:0000 0A 00000000:00000000 00:00000000 00000000  1000        0 777001 1 0000000000000000 100 0 0 10 0\n' >> "$FIXTURE/net/tcp"
+printf '/usr/bin/fixture-daemon\0--serve\0' > "$FIXTURE/4242/cmdline"
+ln -s "socket:[777001]" "$FIXTURE/4242/fd/3"
+
+output=$($ZOHD --proc-root "$FIXTURE" list)
+if echo "$output" | grep -E "^8888 +tcp +4242 +fixture-daemon" > /dev/null; then
+    pass "Fixture listener and owner resolved through --proc-root"
+else
+    fail "Fixture not read: $output"
+fi
+
+# Test 17.2: kill fails when the port is busy but its owner can't be found
+rm "$FIXTURE/4242/fd/3"
+status=0
+output=$($ZOHD --proc-root "$FIXTURE" kill 8888 --force 2>&1) || status=$?
+if [ $status -eq 1 ] && echo "$output" | grep -q "Could not find process information for port 8888"; then
+    pass "kill exits 1 for a busy port with no known owner"
+else
+    fail "kill with no owner: status $status, $output"
+fi
+rm -rf "$FIXTURE"
+
+section "Test 18: Profiling"
+
+# Test 18.1: --profile reports the fd walk and snapshot phases on stderr
+output=$($ZOHD --profile list 2>&1 > /dev/null)
+if echo "$output" | grep -q "^snapshot" && echo "$output" | grep -q "^all threads"; then
+    pass "--profile prints a phase summary"
+else
+    fail "--profile summary missing: $output"
+fi
+
+# Test 18.2: --trace writes trace-event JSON
+TRACE=$(mktemp)
+$ZOHD --trace "$TRACE" list > /dev/null
+if grep -q '"traceEvents"' "$TRACE" && grep -q '"ph":"X"' "$TRACE"; then
+    pass "--trace writes a trace file"
+else
+    fail "--trace output missing"
+fi
+rm -f "$TRACE"
+
+section "Test 19: Port leases"
+
+LEASE_DIR=$(mktemp -d)
+LEASE_SOCK="$LEASE_DIR/lease.sock"
+$ZOHD lease --serve --socket "$LEASE_SOCK" --range 41000-41099 &
+LEASE_PID=$!
+sleep 0.3
+
+# Test 19.1: Leases never overlap
+ports=$( ($ZOHD lease --socket "$LEASE_SOCK" -n 5; $ZOHD lease --socket "$LEASE_SOCK" -n 5) | sort)
+if [ "$(echo "$ports" | wc -l)" -eq 10 ] && [ -z "$(echo "$ports" | uniq -d)" ]; then
+    pass "10 leased ports are unique"
+else
+    fail "Duplicate or missing leases: $ports"
+fi
+
+# Test 19.2: A command gets $PORT, and the lease ends with it
+output=$($ZOHD lease --socket "$LEASE_SOCK" -- sh -c 'echo $PORT')
+if [ "$output" -ge 41000 ] && [ "$output" -le 41099 ]; then
+    pass "lease -- CMD exports PORT=$output"
+else
+    fail "PORT not exported: $output"
+fi
+if $ZOHD lease --socket "$LEASE_SOCK" --status | grep -q "leased=10 "; then
+    pass "Command lease released on exit"
+else
+    fail "Lease status: $($ZOHD lease --socket "$LEASE_SOCK" --status)"
+fi
+
+# Test 19.3: --bound hands over a socket already bound to $PORT
+if command -v python3 &> /dev/null; then
+    output=$($ZOHD lease --socket "$LEASE_SOCK" --bound -- python3 -c \
+        'import os, socket; s = socket.socket(fileno=3); print(s.getsockname()[1] == int(os.environ["PORT"]))')
+    if [ "$output" = "True" ]; then
+        pass "--bound passes the bound socket as fd 3"
+    else
+        fail "--bound socket mismatch: $output"
+    fi
+fi
+
+# Test 19.4: Exhausting the range fails cleanly
+if ! $ZOHD lease --socket "$LEASE_SOCK" -n 200 2>/dev/null; then
+    pass "Oversized lease rejected"
+else
+    fail "Leased more ports than the range holds"
+fi
+
+# Test 19.5: RELEASE only frees ports the requesting connection leased
+if command -v python3 &> /dev/null; then
+    output=$(python3 - "$LEASE_SOCK" <<'PY'
+import socket, sys
+def connect():
+    s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    s.connect(sys.argv[1])
+    return s.makefile("rw")
+def ask(conn, line):
+    conn.write(line + "\n"); conn.flush()
+    return conn.readline().strip()
+owner, other = connect(), connect()
+port = ask(owner, "LEASE 1 0").split()[1]
+print(ask(other, "RELEASE " + port))
+print(ask(owner, "RELEASE " + port))
+PY
+)
+    if [ "$output" = "$(printf 'ERR not leased by this client\nOK')" ]; then
+        pass "RELEASE refused for another client's port"
+    else
+        fail "RELEASE ownership: $output"
+    fi
+fi
+
+kill $LEASE_PID 2>/dev/null || true
+wait $LEASE_PID 2>/dev/null || true
+rm -rf "$LEASE_DIR"
+
+section "Test 20: Kill and Wait"
+
+if command -v python3 &> /dev/null; then
+    python3 -m http.server 8901 > /dev/null 2>&1 &
+    TEST_SERVERS+=($!)
+    python3 -c 'import signal, socket, time
+signal.signal(signal.SIGTERM, signal.SIG_IGN)
+s = socket.socket(); s.bind(("", 8902)); s.listen(); time.sleep(60)' &
+    TEST_SERVERS+=($!)
+    sleep 0.5
+
+    # Test 20.1: A process ignoring SIGTERM holds its port past the timeout
+    set +e
+    output=$($ZOHD kill 8901-8902 --force --wait --timeout 0.5 2>&1)
+    status=$?
+    set -e
+    if [ $status -eq 1 ] && echo "$output" | grep -q "Port 8901 released in" \
+        && echo "$output" | grep -q "Port 8902 still in use"; then
+        pass "--wait reports released and held ports"
+    else
+        fail "--wait: status $status"
+        echo "Output: $output"
+    fi
+
+    # Test 20.2: --escalate SIGKILLs it and the port is confirmed free
+    if output=$($ZOHD kill 8902 --force --wait --timeout 0.5 --escalate) \
+        && echo "$output" | grep -q "Port 8902 released in .*SIGKILL"; then
+        pass "--escalate frees the port"
+    else
+        fail "--escalate: $output"
+    fi
+
+    # Test 20.3: Only the killed owner's protocol is waited for; another
+    # process's UDP socket on the same port number does not hold it up
+    python3 -m http.server 8914 > /dev/null 2>&1 &
+    TEST_SERVERS+=($!)
+    python3 -c "import socket, time; s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM); s.bind(('', 8914)); time.sleep(30)" &
+    UDP_PID=$!
+    TEST_SERVERS+=($UDP_PID)
+    sleep 0.5
+    if output=$($ZOHD kill 8914 --force --wait --timeout 2 2>&1) \
+        && echo "$output" | grep -q "Port 8914 released in" && kill -0 $UDP_PID 2>/dev/null; then
+        pass "--wait ignores other protocols on the killed port"
+    else
+        fail "--wait on 8914: $output"
+    fi
+    kill $UDP_PID 2>/dev/null || true
+fi
+
+# Test 20.4: --escalate without --wait is rejected
+if ! $ZOHD kill 8902 --escalate > /dev/null 2>&1; then
+    pass "--escalate requires --wait"
+else
+    fail "--escalate accepted without --wait"
+fi
+
+section "Test 21: Readiness Gates"
+
+# Test 21.1: wait-listen times out with status 1 on a closed port
+set +e
+$ZOHD wait-listen 8903 --timeout 0.2 > /dev/null 2>&1
+status=$?
+set -e
+if [ $status -eq 1 ]; then
+    pass "wait-listen times out on a closed port"
+else
+    fail "wait-listen timeout status $status"
+fi
+
+if command -v python3 &> /dev/null; then
+    # Test 21.2: wait-listen returns once a server comes up
+    (sleep 0.3; exec python3 -m http.server 8903 > /dev/null 2>&1) &
+    TEST_SERVERS+=($!)
+    if $ZOHD wait-listen 8903 --timeout 5 | grep -q "Port 8903 is listening"; then
+        pass "wait-listen sees the server start"
+    else
+        fail "wait-listen missed the server"
+    fi
+
+    # Test 21.3: wait-free returns once it stops
+    (sleep 0.3; kill ${TEST_SERVERS[-1]}) &
+    if $ZOHD wait-free 8903 --timeout 5 | grep -q "Port 8903 is free"; then
+        pass "wait-free sees the server stop"
+    else
+        fail "wait-free missed the server stopping"
+    fi
+fi
+
+section "Test 22: PID Metadata Cache"
+
+CACHE_DIR=$(mktemp -d)
+
+# Test 22.1: Cached and uncached runs agree, and the cache file appears
+first=$(XDG_RUNTIME_DIR="$CACHE_DIR" $ZOHD list)
+second=$(XDG_RUNTIME_DIR="$CACHE_DIR" $ZOHD list)
+uncached=$(XDG_RUNTIME_DIR="$CACHE_DIR" $ZOHD --no-cache list)
+if [ -f "$CACHE_DIR/zohd-pid-cache" ] && [ "$first" = "$second" ] && [ "$second" = "$uncached" ]; then
+    pass "Cached list matches --no-cache"
+else
+    fail "Cached and uncached list differ"
+fi
+
+# Test 22.2: A warm cache reads only stat per owner (list otherwise opens cmdline and status)
+cold=$(XDG_RUNTIME_DIR="$CACHE_DIR" $ZOHD --no-cache --profile list 2>&1 >/dev/null | awk '/^process_info/ {print $4}')
+warm=$(XDG_RUNTIME_DIR="$CACHE_DIR" $ZOHD --profile list 2>&1 >/dev/null | awk '/^process_info/ {print $4}')
+if [ -z "$cold" ] || [ "$warm" -lt "$cold" ]; then
+    pass "Warm cache opens fewer files than an uncached run"
+else
+    fail "Warm cache opened $warm files, uncached $cold"
+fi
+rm -rf "$CACHE_DIR"
+
+section "Test 23: Reverse Lookup"
+
+if command -v python3 &> /dev/null; then
+    python3 -m http.server 8904 > /dev/null 2>&1 &
+    SERVER_PID=$!
+    TEST_SERVERS+=($SERVER_PID)
+    sleep 0.5
+
+    # Test 23.1: --pid lists exactly the server's port
+    if $ZOHD ports --pid $SERVER_PID | grep -E "^8904 +tcp +$SERVER_PID" > /dev/null; then
+        pass "ports --pid finds the server's listener"
+    else
+        fail "ports --pid missed port 8904"
+    fi
+
+    # Test 23.2: --name and --user narrow to matching processes
+    if $ZOHD ports --name python3 --user "$(id -u)" | grep -q "^8904 "; then
+        pass "ports --name/--user finds the server"
+    else
+        fail "ports --name/--user missed port 8904"
+    fi
+
+    # Test 23.3: Only the target's fd directory is scanned
+    dirs=$($ZOHD --profile ports --pid $SERVER_PID 2>&1 >/dev/null | awk '/^all threads/ {print $4}')
+    if [ "$dirs" = "1" ]; then
+        pass "ports --pid scans one fd directory"
+    else
+        fail "ports --pid scanned $dirs directories"
+    fi
+fi
+
+# Test 23.4: A filter is required, and unknown users are an error
+if ! $ZOHD ports > /dev/null 2>&1 && ! $ZOHD ports --user no-such-user-zohd > /dev/null 2>&1; then
+    pass "ports rejects missing filters and unknown users"
+else
+    fail "ports accepted bad arguments"
+fi
+
+# Test 23.5: Numeric uids past 32 bits are unknown, not truncated
+output=$($ZOHD ports --user 4294967296 2>&1) || true
+output_long=$($ZOHD ports --user 99999999999999999999999 2>&1) || true
+if echo "$output" | grep -q "Unknown user: 4294967296" \
+        && echo "$output_long" | grep -q "Unknown user: 99999999999999999999999"; then
+    pass "ports --user rejects out-of-range uids"
+else
+    fail "Out-of-range uid accepted: $output / $output_long"
+fi
+
+section "Test 24: Single-Port Owner Search"
+
+if command -v python3 &> /dev/null; then
+    HINT_DIR=$(mktemp -d)
+    python3 -m http.server 8905 > /dev/null 2>&1 &
+    SERVER_PID=$!
+    TEST_SERVERS+=($SERVER_PID)
+    sleep 0.5
+
+    # Test 24.1: The second lookup goes straight to the recorded owner
+    XDG_RUNTIME_DIR="$HINT_DIR" $ZOHD check 8905 > /dev/null || true
+    dirs=$(XDG_RUNTIME_DIR="$HINT_DIR" $ZOHD --profile check 8905 2>&1 >/dev/null | awk '/^all threads/ {print $4}')
+    if [ "$dirs" -le 1 ] && XDG_RUNTIME_DIR="$HINT_DIR" $ZOHD check 8905 | grep -q "PID: $SERVER_PID"; then
+        pass "Owner hint resolves port 8905 with one fd directory"
+    else
+        fail "Hinted lookup scanned $dirs directories"
+    fi
+
+    # Test 24.2: A stale hint falls back to a search
+    kill $SERVER_PID
+    python3 -m http.server 8905 > /dev/null 2>&1 &
+    SERVER_PID=$!
+    TEST_SERVERS+=($SERVER_PID)
+    sleep 0.5
+    if XDG_RUNTIME_DIR="$HINT_DIR" $ZOHD check 8905 | grep -q "PID: $SERVER_PID"; then
+        pass "Stale hint ignored, new owner found"
+    else
+        fail "Stale hint returned the wrong owner"
+    fi
+    rm -rf "$HINT_DIR"
+
+    # Test 24.3: A socket held by another user's process is found by
+    # walking each fd directory at most once
+    if [ "$(id -u)" -eq 0 ]; then
+        python3 -c "
+import os, socket, time
+s = socket.socket()
+s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+s.bind(('127.0.0.1', 8915))
+s.listen()
+os.setuid(65534)
+time.sleep(30)
+" &
+        SERVER_PID=$!
+        TEST_SERVERS+=($SERVER_PID)
+        sleep 0.5
+        processes=$(ls /proc | grep -c '^[0-9]')
+        dirs=$($ZOHD --no-cache --profile check 8915 2>&1 >/dev/null | awk '/^all threads/ {print $4}')
+        if [ "$dirs" -le $((processes + 5)) ] && $ZOHD --no-cache check 8915 | grep -q "PID: $SERVER_PID"; then
+            pass "Owner under another uid found in $dirs fd directories ($processes processes)"
+        else
+            fail "Owner search scanned $dirs fd directories for $processes processes"
+        fi
+        kill $SERVER_PID 2>/dev/null || true
+    fi
+fi
+
+section "Test 25: Shared Process Records"
+
+if command -v python3 &> /dev/null; then
+    python3 -c "
+import socket, time
+held = []
+for port in (8906, 8907, 8908):
+    s = socket.socket()
+    s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    s.bind(('127.0.0.1', port))
+    s.listen()
+    held.append(s)
+time.sleep(30)
+" &
+    SERVER_PID=$!
+    TEST_SERVERS+=($SERVER_PID)
+    sleep 0.5
+
+    # Test 25.1: Every socket of one process carries the same owner
+    rows=$($ZOHD --format csv list | awk -F, -v pid=$SERVER_PID '$10 == pid {print $1 "," $11 "," $13}' | sort)
+    if [ "$(echo "$rows" | wc -l)" -eq 3 ] && [ "$(echo "$rows" | cut -d, -f2- | sort -u | wc -l)" -eq 1 ]; then
+        pass "Three sockets listed with one shared owner record"
+    else
+        fail "Unexpected rows for PID $SERVER_PID: $rows"
+    fi
+    kill $SERVER_PID 2>/dev/null || true
+fi
+
+section "Test 26: SO_REUSEPORT Groups"
+
+if command -v python3 &> /dev/null; then
+    for i in 1 2 3; do
+        python3 -c "
+import socket, time
+s = socket.socket()
+s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEPORT, 1)
+s.bind(('127.0.0.1', 8909))
+s.listen()
+time.sleep(30)
+" &
+        TEST_SERVERS+=($!)
+    done
+    sleep 0.5
+
+    # Test 26.1: info lists every worker, not just the first
+    if $ZOHD info 8909 | grep -q "127.0.0.1:8909  3 sockets, 3 processes"; then
+        pass "All three reuseport workers reported"
+    else
+        fail "Reuseport group not reported by info"
+    fi
+
+    # Test 26.2: Connections nobody accepts show up in the accept queue
+    python3 -c "
+import socket, time
+held = [socket.create_connection(('127.0.0.1', 8909)) for _ in range(6)]
+time.sleep(5)
+" &
+    CLIENT_PID=$!
+    sleep 0.5
+    queued=$($ZOHD --format csv list | awk -F, '$1 == 8909 {sum += $16} END {print sum + 0}')
+    if [ "$queued" -eq 6 ]; then
+        pass "Accept queues hold the 6 pending connections"
+    else
+        fail "Expected 6 queued connections, got $queued"
+    fi
+    kill $CLIENT_PID 2>/dev/null || true
+
+    # Test 26.3: A preforked listener is held by the parent and every worker
+    python3 -c "
+import os, signal, socket, time
+s = socket.socket()
+s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+s.bind(('127.0.0.1', 8910))
+s.listen()
+workers = []
+for i in range(2):
+    pid = os.fork()
+    if pid == 0:
+        time.sleep(30)
+        os._exit(0)
+    workers.append(pid)
+signal.signal(signal.SIGTERM, lambda *_: [os.kill(w, signal.SIGKILL) for w in workers] and os._exit(0))
+time.sleep(30)
+" &
+    SERVER_PID=$!
+    TEST_SERVERS+=($SERVER_PID)
+    sleep 0.5
+    output=$($ZOHD list -g)
+    if echo "$output" | grep -q "127.0.0.1:8910  1 socket, 3 processes" &&
+       [ "$(echo "$output" | grep -A4 "127.0.0.1:8910" | grep -c python3)" -eq 3 ]; then
+        pass "Fork-shared listener lists all three holders"
+    else
+        fail "Fork-shared listener holders missing: $(echo "$output" | grep -A4 "127.0.0.1:8910")"
+    fi
+    kill $SERVER_PID 2>/dev/null || true
+fi
+
+section "Test 27: Connection Top"
+
+if command -v python3 &> /dev/null; then
+    python3 -c "
+import socket, time
+srv = socket.socket()
+srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+srv.bind(('127.0.0.1', 8911))
+srv.listen()
+clients = []
+for i in range(5):
+    c = socket.socket()
+    c.bind(('127.0.0.%d' % (i + 1), 0))
+    c.connect(('127.0.0.1', 8911))
+    clients.append((c, srv.accept()[0]))
+clients[0][0].close()  # Leaves its server side in CLOSE_WAIT
+time.sleep(30)
+" &
+    SERVER_PID=$!
+    TEST_SERVERS+=($SERVER_PID)
+    sleep 0.5
+
+    # Test 27.1: Per-state counts and distinct peers for the listening port
+    # (columns: PORT LISTEN ESTAB SYN-RECV FIN-WAIT TIME-WAIT CLOSE-WAIT OTHER RECV-Q SEND-Q PEERS)
+    row=$($ZOHD top -n 1 -r 0 | awk '$1 == 8911')
+    if echo "$row" | awk '{exit !($2 == 1 && $3 == 4 && $7 == 1 && $11 == 5)}'; then
+        pass "top counts 4 established, 1 close-wait from 5 peers"
+    else
+        fail "Unexpected top row: $row"
+    fi
+
+    # Test 27.2: Both backends agree
+    procfs_row=$($ZOHD --backend procfs top -n 1 -r 0 | awk '$1 == 8911')
+    if [ "$row" = "$procfs_row" ]; then
+        pass "procfs and netlink top rows match"
+    else
+        fail "Backends disagree: '$row' vs '$procfs_row'"
+    fi
+    kill $SERVER_PID 2>/dev/null || true
+fi
+
+section "Test 28: Ephemeral Ports"
+
+make_fixture
+mkdir -p "$FIXTURE/sys/net/ipv4" "$FIXTURE/4243/fd"
+row() {  # local_port(hex) remote_address:port(hex) state inode
+    printf '   0: 0100007F:%s %s %s 00000000:00000000 00:00000000 00000000  1000        0 %s 1 0000000000000000 100 0 0 10 0\n' "$@"
+}
+{
+    row 9C72 00000000:0000 0A 9000      # Listener on 40050, inside the range
+    row 9C72 0100007F:D431 01 9001      # Accepted on 40050: not outbound
+    row 9C41 0500000A:1538 01 9002      # 40001 -> 10.0.0.5:5432
+    row 9C42 0500000A:1538 01 9003
+    row 9C43 0500000A:1538 01 9004
+    row 9C44 0500000A:1538 06 0         # TIME_WAIT, no owner
+    row 1F90 0500000A:1538 01 9005      # Local port 8080: outside the range
+} >> "$FIXTURE/net/tcp"
+echo "40000	40099" > "$FIXTURE/sys/net/ipv4/ip_local_port_range"
+echo "40090-40099" > "$FIXTURE/sys/net/ipv4/ip_local_reserved_ports"
+printf 'fixture-client\0' > "$FIXTURE/4243/cmdline"
+for inode in 9002 9003 9004; do ln -s "socket:[$inode]" "$FIXTURE/4243/fd/$inode"; done
+
+# Test 28.1: Range, destination headroom and owners from one pass
+# (90 usable ports - 1 listener - 4 sockets to the destination = 85)
+output=$($ZOHD --proc-root "$FIXTURE" ephemeral)
+if echo "$output" | grep -q "40000-40099, 90 usable ports (10 reserved)" &&
+   echo "$output" | grep -Eq "^10.0.0.5:5432 +4 +1 +85 " &&
+   echo "$output" | grep -Eq "^4243 +fixture-client +3$"; then
+    pass "ephemeral reports headroom and owners"
+else
+    fail "Unexpected ephemeral report: $output"
+fi
+
+# Test 28.2: suggest skips ports the kernel may assign, but not reserved
+# ones. With every port ephemeral, 3000-3002 reserved and 3001 busy, 3000
+# and 3002 are the only valid answers, in whatever order they come.
+echo "1 65535" > "$FIXTURE/sys/net/ipv4/ip_local_port_range"
+echo "3000-3002" > "$FIXTURE/sys/net/ipv4/ip_local_reserved_ports"
+row 0BB9 00000000:0000 0A 9006 >> "$FIXTURE/net/tcp"
+ports=$($ZOHD --proc-root "$FIXTURE" suggest -n 5 | awk '$1 ~ /^[0-9]+$/ {print $1}' | sort -n | tr '\n' ' ')
+if [ -n "$ports" ] && ! echo "$ports" | tr ' ' '\n' | grep -Ev '^(3000|3002)?$' > /dev/null; then
+    pass "suggest keeps to free reserved ports inside the ephemeral range ($ports)"
+else
+    fail "suggest offered ephemeral or busy ports: $ports"
+fi
+rm -rf "$FIXTURE"
+
+section "Test 29: Batched Process Reads"
+
+# 20 owners, enough for a batch; one has a first argument longer than a
+# batch read, which must be re-read in full
+make_fixture
+long_name=$(printf 'x%.0s' $(seq 1500))
+{
+    for i in $(seq 0 19); do
+        pid=$((5000 + i))
+        mkdir -p "$FIXTURE/$pid/fd"
+        if [ $i -eq 7 ]; then
+            printf '/opt/%s\0--flag\0' "$long_name" > "$FIXTURE/$pid/cmdline"
+        else
+            printf '/usr/bin/batch-%s\0--serve\0' $i > "$FIXTURE/$pid/cmdline"
+        fi
+        echo "$pid (batch-$i) S 1 $pid $pid 0 -1 4194560 100 0 0 0 1 1 0 0 20 0 1 0 $((1000 + i)) 1000 100" > "$FIXTURE/$pid/stat"
+        printf 'Name:\tbatch-%s\nState:\tS (sleeping)\nPid:\t%s\nUid:\t%s\t%s\t%s\t%s\n' $i $pid $((2000 + i)) 0 0 0 > "$FIXTURE/$pid/status"
+        ln -s "socket:[$((880000 + i))]" "$FIXTURE/$pid/fd/3"
+        printf '   %d: 0100007F:%04X 00000000:0000 0A 00000000:00000000 00:00000000 00000000  1000        0 %d 1 0000000000000000 100 0 0 10 0\n' $i $((20000 + i)) $((880000 + i))
+    done
+} >> "$FIXTURE/net/tcp"
+
+# Test 29.1: --io-uring resolves the same owners as one-by-one reads
+plain=$($ZOHD --proc-root "$FIXTURE" --numeric-users --format json list)
+batched=$($ZOHD --proc-root "$FIXTURE" --numeric-users --format json --io-uring list)
+if [ "$plain" = "$batched" ] && echo "$batched" | grep -q '"user": *"2019"' &&
+   echo "$batched" | grep -q "$long_name"; then
+    pass "Batched and one-by-one process reads agree"
+else
+    fail "--io-uring changed list output"
+fi
+rm -rf "$FIXTURE"
+
+section "Test 30: Accept Queue Backlog"
+
+if command -v python3 &> /dev/null; then
+    # A listener with backlog 4 that never accepts; the queue stops at 5
+    python3 -c "
+import socket, time
+srv = socket.socket()
+srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+srv.bind(('127.0.0.1', 8912))
+srv.listen(4)
+time.sleep(1)
+clients = []
+for i in range(8):
+    c = socket.socket()
+    c.setblocking(False)
+    c.connect_ex(('127.0.0.1', 8912))
+    clients.append(c)
+time.sleep(30)
+" &
+    SERVER_PID=$!
+    TEST_SERVERS+=($SERVER_PID)
+    sleep 0.3
+
+    # Test 30.1: --threshold samples until the queue fills, then exits 1
+    status=0
+    output=$($ZOHD backlog 8912 --threshold 100 -n 1000) || status=$?
+    if [ $status -eq 1 ] && echo "$output" | grep -q "SATURATED  127.0.0.1:8912  queue 5/4 (125%)  pid $SERVER_PID"; then
+        pass "backlog --threshold caught the full accept queue"
+    else
+        fail "No saturation alert (exit $status): $output"
+    fi
+
+    # Test 30.2: One-shot table with queue, limit and owner
+    if $ZOHD backlog 8912 | grep -Eq "^127.0.0.1:8912 +5 +4 +125% +$SERVER_PID +python3"; then
+        pass "backlog shows queue against backlog"
+    else
+        fail "Unexpected backlog table: $($ZOHD backlog 8912)"
+    fi
+
+    # Test 30.3: Without saturation it stops after --count samples, status 0
+    if $ZOHD backlog 1 --threshold 50 -n 3 | grep -q "in 3 samples"; then
+        pass "backlog --threshold exits cleanly without saturation"
+    else
+        fail "backlog --threshold did not stop after --count"
+    fi
+
+    # Test 30.4: Backends without backlog limits are refused before sampling
+    if $ZOHD --backend procfs backlog 1 --threshold 50 -n 3 2>&1 | grep -q "only the netlink backend"; then
+        pass "backlog --threshold refuses the procfs backend"
+    else
+        fail "backlog --threshold sampled procfs without backlog limits"
+    fi
+    kill $SERVER_PID 2>/dev/null || true
+fi
+
 # Tests complete - cleanup will run via trap